@@ -165,6 +165,12 @@ btnDisabled("Disabled & too long", *this,
         aWidgets.emplace_back(new TFW::Label(std::to_string(eCol), *this, TFW::POS_AFTER_PRV, 0, TFW::POS_SAME_PRV, 0, TFW::POS_FIXED_LEN, 50, TFW::POS_SAME_PRV, 0));
         aWidgets.back()->SetBkColor(eCol);
     }
+    // XP's theme colors hardly ever change, checking them twice a second suffices
+    SetXPColorsRefresh(30);
+    // mostly static content: draw it only when something changed
+    SetRenderCache(true);
+    // data-driven changes need not show faster than 10 times a second
+    SetMaxRefreshRate(10);
     
     // Some basic tests of Listbox code
     
@@ -175,7 +181,14 @@ btnDisabled("Disabled & too long", *this,
     list.AddCol(COL_BOARDED,    {"Boarded",  40, TFW::DTY_CHECKBOX});
     list.AddCol(COL_FUEL,       {"Fuel",     60, TFW::DTY_DOUBLE});
     list.AddCol(COL_TYPE,       {"Type",     40});   // this is a string, i.e. a left-aligned columnd following a right-aligned column, which requires some extra space so that text doesn't directly connect
-    list.AddCol(COL_NAME,       {"Name",    100});   // overwrite first element
+    list.AddCol(COL_NAME,       {"Name",    100, TFW::DTY_STRING, true, TFW::COLL_NATURAL});   // overwrite first element, sort "A320" before "A380" and case-insensitively
+    list.SetColAutoWidth(COL_TYPE);                                 // as wide as the widest type
+    list.SetMultiSelect(true);                                      // ctrl/shift-click, shift+cursor keys, ctrl-A
+    list.SetColAggregate(COL_PAX, TFW::AGG_SUM);                    // total pax in the footer row
+    list.SetColAggregate(COL_FUEL, TFW::AGG_MEAN);                  // average fuel in the footer row
+    list.SetFooter(true);
+    list.AddFormatRule(COL_FUEL, {TFW::FMT_LESS, 200.0, list.AddStyle(TFW::COL_RED, true)});   // low fuel in bold red
+    list.SetRowPoolLimit(50);                                       // keep up to 50 replaced/removed rows for reuse by ObtainRow()
 
     // Add some rows
     list.AddRow({(void*)1, {{"Cessna 152"},     {"EDDL"}, {true},   {2},  {123.456}, {"C152"}}});
@@ -210,6 +223,8 @@ btnDisabled("Disabled & too long", *this,
     (*list.FindRow((void*)9))[COL_NAME].SetColor(TFW::COL_YELLOW);
     tenthRow[COL_TYPE].SetColor(TFW::COL_BLUE);
     tenthRow[COL_NAME].SetColor(TFW::COL_CYAN);
+    // fill a row in place, reusing the storage of the row replaced by "Airbus A320neo"
+    list.AddRow(std::move(list.ObtainRow((void*)11).Assign("Eleven", "EDDM", true, 11, 1100.0, "B738")));
 
     
     // Check boxes
@@ -333,6 +348,9 @@ PLUGIN_API int XPluginStart(
 
 PLUGIN_API int  XPluginEnable(void)
 {
+    // draw all text from a font atlas, batched per window
+    TFW::SetTextAtlas(true);
+    
     // we open the window upon startup
     OpenAndDisplayTheWnd();
     
@@ -361,6 +379,8 @@ PLUGIN_API void XPluginReceiveMessage(XPLMPluginID inFrom, int inMsg, void * /*i
 PLUGIN_API void XPluginDisable(void)
 {
     RemoveTheWnd();
+    // frees the font atlas' texture
+    TFW::SetTextAtlas(false);
 }
 
 PLUGIN_API void    XPluginStop(void)
@@ -22,14 +22,30 @@
 #include "TFWGraphics.h"
 
 #if IBM
+#include <windows.h>
+#include <intrin.h>
 // we prefer std::max/min
 #undef max
 #undef min
 #endif
 
+#if APL || LIN
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <cassert>
+#include <cctype>
+#include <climits>
 #include <algorithm>
+#include <charconv>
 #include <chrono>
+#include <fstream>
+#include <string_view>
+#include <thread>
 #include "XPLMGraphics.h"
 #include "XPLMDataAccess.h"
 #include "XPLMProcessing.h"
@@ -40,7 +56,15 @@
 namespace TFW {
     
     constexpr int TEXT_OFS = 3;         ///< offset from bottom when using XPLMDrawString
+    constexpr int COL_GRAB_DIST = 3;    ///< distance from a column border, in which the border can be grabbed for resizing
+    constexpr int TYPE_AHEAD_TIMEOUT_MS = 1000; ///< type-ahead search starts over if no key was pressed for this long
+    constexpr int TREE_INDENT_CHARS = 2;///< indentation per nesting level in a tree list box, in average character widths
+    constexpr float SCROLL_INERTIA_TAU = 0.1f;  ///< [s] time constant, in which scrolling velocity decays to 37%, one wheel click scrolls one row in total
+    constexpr size_t DAMAGE_MAX_AREAS = 8;      ///< more damaged areas of a window are merged into one
+    constexpr int RESIZE_CURSOR_SIZE = 8;       ///< distance from the resize cursor's center to its arrow tips
     int gCHAR_AVG_WIDTH = 8;            ///< Avergae char width in pixel, also defines space between a right-aligned and a left-aligned list column
+    bool gbTextAtlas = false;           ///< draw text from a font atlas? See SetTextAtlas()
+    FrameContext* gpFrameCtx = nullptr; ///< context of the frame currently being drawn, `nullptr` outside of drawing
     
     //
     // MARK: Useful colors
@@ -110,14 +134,25 @@ namespace TFW {
         return gCOL_STD[_code];
     }
     
-    /// @brief Pick one of XP's standard colors
-    /// @param inColorID defines the color to be picked, see `XP_COLOR_DR`
-    /// @param outColor array of 4 floats to receive the color, or NULL if the OpenGL color shall be set immediately instead
-    /// @param inAlphaLevel (optional) alpha level to be added to the color (XP returns none), defaults to 1.0
-    /// @see Taken from https://developer.x-plane.com/code-sample/testwidgets/
-    void SetupAmbientColor (XPStdColorsE inColorID,
-                            float outColor[4] = nullptr,
-                            float inAlphaLevel = 1.0f)
+    // Draw text from a font atlas?
+    void SetTextAtlas (bool _bEnable)
+    {
+        gbTextAtlas = _bEnable;
+        // the atlas is rasterized again when needed
+        if (!gbTextAtlas)
+            TextAtlasRelease();
+    }
+    
+    // Is text drawn from a font atlas?
+    bool IsTextAtlas ()
+    {
+        return gbTextAtlas;
+    }
+    
+    /// @brief Fetch one of XP's standard colors from its dataRef
+    /// @param inColorID defines the color to be fetched, see `XP_COLOR_DR`
+    /// @param outColor array of 3 floats to receive the color
+    static void FetchXPColor (XPStdColorsE inColorID, float outColor[3])
     {
         // If we're running the first time, resolve all of our datarefs just once.
         static    bool    firstTime = true;
@@ -128,16 +163,33 @@ namespace TFW {
                 aXPColorDR[n] = XPLMFindDataRef(XP_COLOR_DR[n]);
         }
         
+        // If we have a dataref, just fetch the color from the ref.
+        if (aXPColorDR[inColorID])
+            XPLMGetDatavf(aXPColorDR[inColorID], outColor, 0, 3);
+        else
+            // otherwise revert to white:
+            std::memmove (outColor, COL_WHITE, sizeof(float[3]));
+    }
+    
+    /// @brief Pick one of XP's standard colors
+    /// @details While drawing, the color comes from the current FrameContext,
+    ///          otherwise it is fetched from its dataRef.
+    /// @param inColorID defines the color to be picked, see `XP_COLOR_DR`
+    /// @param outColor array of 4 floats to receive the color, or NULL if the OpenGL color shall be set immediately instead
+    /// @param inAlphaLevel (optional) alpha level to be added to the color (XP returns none), defaults to 1.0
+    /// @see Taken from https://developer.x-plane.com/code-sample/testwidgets/
+    void SetupAmbientColor (XPStdColorsE inColorID,
+                            float outColor[4] = nullptr,
+                            float inAlphaLevel = 1.0f)
+    {
         // If being asked to set the color immediately, allocate some storage.
         float    theColor[4];
         float * target = outColor ? outColor : theColor;
         
-        // If we have a dataref, just fetch the color from the ref.
-        if (aXPColorDR[inColorID])
-            XPLMGetDatavf(aXPColorDR[inColorID], target, 0, 3);
+        if (gpFrameCtx)
+            std::memmove(target, gpFrameCtx->GetXPColor(inColorID), sizeof(float[3]));
         else
-            // otherwise revert to white:
-            std::memmove (target, COL_WHITE, sizeof(float[4]));
+            FetchXPColor(inColorID, target);
         target[3] = inAlphaLevel;
 
         // If the user passed NULL, set the color now using the alpha level.
@@ -188,6 +240,20 @@ namespace TFW {
         return true;
     }
     
+    /// Shall the text be handled by the font atlas?
+    static bool UseTextAtlas (XPLMFontID _fontId, const char* _s, size_t _len)
+    {
+        return gbTextAtlas && TextAtlasReady(_fontId) && TextAtlasCovers(_s, _len);
+    }
+    
+    /// Width of a text, from the font atlas if in use, otherwise as per `XPLMMeasureString`
+    static float MeasureString (XPLMFontID _fontId, const char* _s, int _len)
+    {
+        if (UseTextAtlas(_fontId, _s, size_t(_len)))
+            return TextAtlasMeasure(_s, size_t(_len));
+        return XPLMMeasureString(_fontId, _s, _len);
+    }
+    
     /// @brief Draws text with alignment: vertically centered, horizontally as specified
     void DrawAlignedString (float *             inColorRGB,
                             const Rect&         inRect,
@@ -198,13 +264,16 @@ namespace TFW {
         // center text vertically in rect, calculate the text's bottom
         const Point c = inRect.Center();
         int fontHeight = 10;
-        XPLMGetFontDimensions(inFontID, &gCHAR_AVG_WIDTH, &fontHeight, nullptr);
+        if (gpFrameCtx)
+            fontHeight = gpFrameCtx->GetFont(inFontID).charHeight;
+        else
+            XPLMGetFontDimensions(inFontID, nullptr, &fontHeight, nullptr);
         const int y = c.y() - fontHeight/2 + TEXT_OFS;      // text baseline
 
         // Alignment needs to consider pixel-width of the text
         int x = inRect.Left();
         if (inAlign != TXA_LEFT) {
-            const int width = (int)std::lround(XPLMMeasureString(inFontID,
+            const int width = (int)std::lround(MeasureString(inFontID,
                                                                  inText.c_str(),
                                                                  (int)inText.length()));
             if (inAlign == TXA_CENTER)
@@ -215,14 +284,14 @@ namespace TFW {
                 x = inRect.Right() - width;
         }
         
-        // get the correct translated color and draw the label
+        // get the correct translated color and queue the label,
+        // drawn by MainWnd::DoDraw() after all other drawing
         float col[4];
         if (TranslateColor(inColorRGB, col))
-            XPLMDrawString(col, x, y,
-                           (char*)inText.c_str(), nullptr, inFontID);
+            TextQueueAdd(col, x, y, inText, inFontID);
     }
     
-    /// @brief Crops a text to fit into a maximum width when drawn
+    /// @brief Determines how much of a text fits into a maximum width when drawn
     /// @details Cropping the actual text to draw (called only when
     ///          text or geometry change) avoids using costly
     ///          cropping frame techniques in each drawing frame.
@@ -230,34 +299,41 @@ namespace TFW {
     /// @param _width The width in pixel the resulting text needs to fit into
     /// @param _startChar (optional) Resulting text starts at _s[_startChar], defaults to `0`
     /// @param _fontId (optional) Font to use for rendering, defaults to `xplmFont_Proportional`
-    std::string CropTextToWidth (const std::string& _s, float _width,
-                                 size_t _startChar = 0,
-                                 XPLMFontID _fontId = xplmFont_Proportional)
+    /// @return Number of characters, starting at `_s[_startChar]`, which fit into `_width`
+    size_t CropTextLen (const std::string& _s, float _width,
+                        size_t _startChar = 0,
+                        XPLMFontID _fontId = xplmFont_Proportional)
     {
         // max number of characters to care about
         const size_t maxChars = _s.size() - _startChar;
 
         // Sanity checks
-        if (maxChars <= 0 || _width < 1.0f) return "";
+        if (maxChars <= 0 || _width < 1.0f) return 0;
         if (gCHAR_AVG_WIDTH <= 0) gCHAR_AVG_WIDTH = 8;
         
         // Educated guess about resulting number of characters
         size_t numChars = size_t(_width / gCHAR_AVG_WIDTH);
         
         // If it is too much we keep reducing until it fits
-        if (XPLMMeasureString(_fontId, _s.c_str() + _startChar, int(numChars)) > _width)
+        if (MeasureString(_fontId, _s.c_str() + _startChar, int(numChars)) > _width)
             while (numChars > 0 &&
-                   XPLMMeasureString(_fontId, _s.c_str() + _startChar, int(--numChars)) > _width);
+                   MeasureString(_fontId, _s.c_str() + _startChar, int(--numChars)) > _width);
         // else we keep incresing it until it's too much
         else
             while (numChars < maxChars &&
-                   XPLMMeasureString(_fontId, _s.c_str() + _startChar, int(numChars+1)) <= _width)
+                   MeasureString(_fontId, _s.c_str() + _startChar, int(numChars+1)) <= _width)
                 numChars++;
         
-        // return the resulting string
-        return _s.substr(_startChar, numChars);
+        return numChars;
     }
 
+    /// Do two areas share any pixel? (Merely touching edges don't count, unlike Rect::Overlap())
+    static bool AreasIntersect (const Rect& a, const Rect& b)
+    {
+        return a.Left() < b.Right() && b.Left() < a.Right() &&
+               a.Bottom() < b.Top() && b.Bottom() < a.Top();
+    }
+    
     /// @brief Computes a fitting square for check boxes / radio buttons
     /// @details Takes of `_r` height as given, returns a square which starts one pixel down/right and
     ///          also ends one pixel up, so that there is (at least) one pixel of room
@@ -369,6 +445,45 @@ namespace TFW {
         DoHandleCursor({x,y});
     }
     
+    //
+    // MARK: Frame Context
+    //
+    
+    // Start a new frame: take the time and, if due, fetch X-Plane's standard colors
+    void FrameContext::Update ()
+    {
+        now = std::chrono::steady_clock::now();
+        ++frameNr;
+        
+        // X-Plane's standard colors: fetch if due, and only count a generation if they changed
+        if (xpColorsGen == 0 || xpColorsRefresh <= 1 || frameNr % xpColorsRefresh == 0) {
+            std::array<std::array<float,3>,COL_XP_COUNT> cols;
+            for (int n = COL_XP_BACKGROUND_RGB; n < COL_XP_COUNT; ++n)
+                FetchXPColor(XPStdColorsE(n), cols[size_t(n)].data());
+            if (xpColorsGen == 0 || std::memcmp(cols.data(), xpColors.data(), sizeof(cols)) != 0) {
+                xpColors = cols;
+                ++xpColorsGen;
+            }
+        }
+        
+        // font metrics are fetched again on first use
+        for (FontMetricsTy& f: fonts)
+            f.bValid = false;
+    }
+    
+    // Dimensions of a font, fetched only once per frame
+    const FontMetricsTy& FrameContext::GetFont (XPLMFontID _fontId)
+    {
+        // fonts we have no slot for are fetched every time
+        const bool bSlot = size_t(_fontId) < fonts.size();
+        FontMetricsTy& f = bSlot ? fonts[size_t(_fontId)] : fontOther;
+        if (!f.bValid || !bSlot) {
+            XPLMGetFontDimensions(_fontId, &f.charWidth, &f.charHeight, nullptr);
+            f.bValid = true;
+        }
+        return f;
+    }
+    
     //
     // MARK: Croppable Text
     //
@@ -376,7 +491,13 @@ namespace TFW {
     // Recalculate `sCropped` from `sFull`
     void CroppedString::UpdateCroppedString ()
     {
-        sCropped = CropTextToWidth(sFull, (float)width, startPos);
+        // without cropping there is no need to duplicate the string
+        if (IsUncropped()) {
+            sCropped.clear();
+            return;
+        }
+        // assign in place, so that sCropped keeps its storage
+        sCropped.assign(sFull, startPos, CropTextLen(sFull, (float)width, startPos));
     }
 
     //
@@ -423,6 +544,14 @@ namespace TFW {
     {
         return this == &mainWnd;
     }
+    
+    // Mark the widget to be drawn anew, also reports its area to the main window as damaged
+    void Widget::SetDirty (bool _bDirty)
+    {
+        bDirty = _bDirty;
+        if (bDirty && !IsMainWnd())
+            mainWnd.AddDamage(*this);
+    }
 
     // Called by MainWnd, this function does the drawing
     void Widget::DoDraw(const Rect& r)
@@ -710,6 +839,7 @@ namespace TFW {
         
         if (FindElem(_elem.refCon) == BUTTON_ELEM_NULL) {
             aBtns.emplace_back(std::move(_elem));
+            SetDirty();
             return true;
         }
         return false;
@@ -745,15 +875,21 @@ namespace TFW {
     void ButtonArray::SetSelected (void* _refCon)
     {
         ButtonElem& elem = FindElem(_refCon);
-        if (elem != BUTTON_ELEM_NULL)
+        if (elem != BUTTON_ELEM_NULL) {
             ButtonClicked(elem);
+            SetDirty();
+        }
     }
 
     // Resizing means we need to recalculate the ButtonElems' positions
     void ButtonArray::SetGeometry(const Rect &_r)
     {
+        // old and new area need to be drawn anew
+        SetDirty();
+        
         // pass up the class hierarchy
         Rect::SetGeometry(_r);
+        SetDirty();
         
         // Update geometry of button elements
         
@@ -987,6 +1123,7 @@ namespace TFW {
         ClipCopy();
         caption.clear();
         caretPos = 0;
+        SetDirty();
     }
     
     // Paste text from clipboard/pasteboard at current caret position
@@ -1004,6 +1141,7 @@ namespace TFW {
                 // insert the actual characters
                 caption.insert(caretPos, s, 0, cpyCnt);
                 caretPos += cpyCnt;             // advance the caret accordingly
+                SetDirty();
             }
         }
     }
@@ -1093,7 +1231,7 @@ namespace TFW {
         const std::string drawTxt = GetDrawString();
         for (; pos <= drawTxt.length(); pos++)
         {
-            if (XPLMMeasureString(xplmFont_Proportional, drawTxt.c_str(), (int)pos) > p.x())
+            if (MeasureString(xplmFont_Proportional, drawTxt.c_str(), (int)pos) > p.x())
                 break;
         }
         
@@ -1158,7 +1296,7 @@ namespace TFW {
                 lastCaretPos = caretPos;
                 lastStartPos = currStartPos;
                 // calculate where the caret would be
-                x = (int)std::lround(XPLMMeasureString(xplmFont_Proportional,
+                x = (int)std::lround(MeasureString(xplmFont_Proportional,
                                                        GetDrawString().c_str(),
                                                        (int)(caretPos - currStartPos)));
             }
@@ -1174,7 +1312,7 @@ namespace TFW {
                        currStartPos < caption.size()-1)
                 {
                     caption.SetStartPos(currStartPos += 5);
-                    x = (int)std::lround(XPLMMeasureString(xplmFont_Proportional,
+                    x = (int)std::lround(MeasureString(xplmFont_Proportional,
                                                            GetDrawString().c_str(),
                                                            (int)(caretPos - currStartPos)));
                 }
@@ -1188,7 +1326,7 @@ namespace TFW {
                 {
                     caption.SetStartPos(currStartPos > 5 ? currStartPos - 5 : 0);
                     currStartPos = caption.GetStartPos();
-                    x = (int)std::lround(XPLMMeasureString(xplmFont_Proportional,
+                    x = (int)std::lround(MeasureString(xplmFont_Proportional,
                                                            GetDrawString().c_str(),
                                                            (int)(caretPos - currStartPos)));
                 }
@@ -1201,15 +1339,11 @@ namespace TFW {
                           xplmFont_Proportional);
         
         // Focus?
+        bCaretDrawn = IsCaretShown();
         if (HasFocus()) {
             // Caret
-            // this makes the caret blink: Only draw it in the first half of any second
-            long long ms;
-            {
-                using namespace std::chrono;
-                ms = time_point_cast<milliseconds>(system_clock::now()).time_since_epoch().count();
-            }
-            if (ms % 1000 < 500) {
+            if (bCaretDrawn) {
+                TextQueueFlush();               // the caret goes on top of the text
                 SetColor(gCOL_STD[COL_SELECTION]);
                 DrawLine({ {_r.Left() + x, _r.Top()-1},
                            {_r.Left() + x, _r.Bottom()+3} });
@@ -1223,6 +1357,17 @@ namespace TFW {
     }
     
     
+    // Is the blinking caret to be shown in the current frame?
+    bool EditField::IsCaretShown () const
+    {
+        if (!HasFocus())
+            return false;
+        // this makes the caret blink: Only draw it in the first half of any second
+        using namespace std::chrono;
+        const long long ms = duration_cast<milliseconds>(mainWnd.GetFrameContext().now.time_since_epoch()).count();
+        return ms % 1000 < 500;
+    }
+    
     // returns the current string to draw, which depends on scrolling and on conversions like password-*
     std::string EditField::GetDrawString () const
     {
@@ -1237,11 +1382,406 @@ namespace TFW {
     /// multi-purpose text buffer, e.g. for snprintf operations
     static char lbBuf[1024];
     
+    //
+    // List box snapshot file format
+    //
+    // header | columns | column order | rows | cells | string offsets | string data
+    //
+    // Each section starts at a multiple of 8 bytes, so that the typed arrays
+    // can be accessed directly in the memory-mapped file.
+    // Cells are stored per column: string indexes of all rows,
+    // followed by `int32_t` values (integer and checkbox columns)
+    // or `double` values (double columns) of all rows.
+    //
+    
+    constexpr char     SNAP_MAGIC[8] = "TFWSNAP";   ///< identifies a list box snapshot file
+    constexpr uint32_t SNAP_BYTE_ORDER = 0x01020304;///< detects files written with another byte order
+    constexpr uint32_t SNAP_VERSION = 1;            ///< snapshot file format version
+    constexpr uint32_t SNAP_NO_VALUE = UINT32_MAX;  ///< string index of a value the row doesn't have
+    
+    /// Snapshot file header
+    struct SnapHeaderTy {
+        char     magic[8];                  ///< SNAP_MAGIC
+        uint32_t byteOrder;                 ///< SNAP_BYTE_ORDER
+        uint32_t version;                   ///< SNAP_VERSION
+        uint32_t numCols;                   ///< number of column definitions
+        uint32_t numRows;                   ///< number of rows
+        uint32_t numStrings;                ///< number of interned strings
+        uint32_t sortedBy;                  ///< column the rows are sorted by
+        int32_t  sorted;                    ///< sorting order
+        uint32_t reserved;
+        uint64_t ofsCols;                   ///< offset of the SnapColTy array
+        uint64_t ofsOrder;                  ///< offset of the column order, `uint32_t` column ids
+        uint64_t ofsRows;                   ///< offset of the SnapRowTy array
+        uint64_t ofsCells;                  ///< offset of the cell arrays
+        uint64_t ofsStrOfs;                 ///< offset of the `uint32_t` string offsets, `numStrings+1` entries
+        uint64_t ofsStrData;                ///< offset of the string data
+        uint64_t fileSize;                  ///< total file size
+    };
+    
+    /// Snapshot of a column definition
+    struct SnapColTy {
+        uint32_t nameIdx;                   ///< string index of the column header
+        int32_t  width;                     ///< column width
+        uint8_t  dataType;                  ///< DataTypeTy
+        uint8_t  bVisible;                  ///< column shown?
+        uint8_t  collation;                 ///< CollationTy
+        uint8_t  bAutoWidth;                ///< auto width?
+        uint8_t  aggregate;                 ///< AggregateTy
+        uint8_t  pad[3];
+    };
+    
+    /// Snapshot of a row's properties
+    struct SnapRowTy {
+        uint64_t refCon;                    ///< `refCon`, stored as integer
+        uint32_t sequNr;                    ///< sequence number, order of "unsorted" data
+        uint32_t height;                    ///< row height, 0 for standard
+    };
+    
+    /// Round up to the next multiple of 8
+    inline uint64_t SnapAlign (uint64_t _n) { return (_n + 7) & ~uint64_t(7); }
+    
+    /// Size of a column's cell arrays in a snapshot with `_numRows` rows
+    static uint64_t SnapCellsSize (uint8_t _dataType, uint32_t _numRows)
+    {
+        uint64_t n = SnapAlign(uint64_t(_numRows) * sizeof(uint32_t));
+        if (_dataType == DTY_INT || _dataType == DTY_CHECKBOX)
+            n += SnapAlign(uint64_t(_numRows) * sizeof(int32_t));
+        else if (_dataType == DTY_DOUBLE)
+            n += uint64_t(_numRows) * sizeof(double);
+        return n;
+    }
+    
+    /// A read-only memory-mapped file
+    class MappedFile {
+    public:
+        const char* data = nullptr;         ///< file content, `nullptr` if the file could not be mapped
+        size_t      size = 0;               ///< file size
+    protected:
+#if IBM
+        HANDLE      hFile = INVALID_HANDLE_VALUE;   ///< file handle
+        HANDLE      hMap = NULL;            ///< file mapping handle
+#else
+        int         fd = -1;                ///< file descriptor
+#endif
+    public:
+        /// Maps the file
+        MappedFile (const std::string& _path)
+        {
+#if IBM
+            hFile = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            LARGE_INTEGER fSize;
+            if (hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(hFile, &fSize) || fSize.QuadPart <= 0)
+                return;
+            hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (!hMap)
+                return;
+            data = (const char*)MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+            if (data)
+                size = size_t(fSize.QuadPart);
+#else
+            fd = open(_path.c_str(), O_RDONLY);
+            struct stat st;
+            if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0)
+                return;
+            void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+                return;
+            data = (const char*)p;
+            size = size_t(st.st_size);
+#endif
+        }
+        
+        /// Unmaps the file
+        ~MappedFile ()
+        {
+#if IBM
+            if (data) UnmapViewOfFile(data);
+            if (hMap) CloseHandle(hMap);
+            if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+#else
+            if (data) munmap((void*)data, size);
+            if (fd >= 0) close(fd);
+#endif
+        }
+        
+        MappedFile (const MappedFile&) = delete;
+        MappedFile& operator = (const MappedFile&) = delete;
+    };
+    
+    /// Minimum size of a chunk of a delimited file parsed by one thread
+    constexpr size_t IMPORT_MIN_CHUNK = 64 * 1024;
+    
+    /// @brief Split off the next field of a delimited line
+    /// @param p Start of the field
+    /// @param eol End of the line
+    /// @param _delim Field delimiter
+    /// @param quoted Buffer for unquoting a field enclosed in double quotes
+    /// @param[out] field The field's content, pointing into the line or into `quoted`
+    /// @return Start of the next field, `eol` if there is none
+    static const char* NextField (const char* p, const char* eol, char _delim,
+                                  std::string& quoted, std::string_view& field)
+    {
+        // plain field: up to the next delimiter
+        if (p >= eol || *p != '"') {
+            const char* e = (const char*)memchr(p, _delim, size_t(eol - p));
+            if (!e) e = eol;
+            field = std::string_view(p, size_t(e - p));
+            return e < eol ? e + 1 : eol;
+        }
+        // quoted field: up to the closing quote, `""` is a quote character
+        quoted.clear();
+        for (++p; p < eol; ++p) {
+            if (*p == '"') {
+                if (p + 1 < eol && p[1] == '"')
+                    ++p;
+                else {
+                    ++p;
+                    break;
+                }
+            }
+            quoted += *p;
+        }
+        field = quoted;
+        // skip anything up to the delimiter
+        while (p < eol && *p != _delim)
+            ++p;
+        return p < eol ? p + 1 : eol;
+    }
+    
+    /// Remove leading and trailing blanks
+    static std::string_view TrimField (std::string_view s)
+    {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+        while (!s.empty() && (s.back()  == ' ' || s.back()  == '\t')) s.remove_suffix(1);
+        return s;
+    }
+    
+    /// Does a checkbox field read as unchecked, i.e. empty, `0`, `false`, `no`, or `off` in any case?
+    static bool IsFalseField (std::string_view s)
+    {
+        auto iEquals = [s](std::string_view word)
+        {
+            return s.size() == word.size() &&
+            std::equal(s.begin(), s.end(), word.begin(),
+                       [](char a, char b) { return std::tolower((unsigned char)a) == b; });
+        };
+        return s.empty() || s == "0" || iEquals("false") || iEquals("no") || iEquals("off");
+    }
+    
+    /// Parse a double, locale-independent if `std::from_chars` supports floating point
+    static bool ParseDouble (std::string_view s, double& d)
+    {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        if (!s.empty() && s.front() == '+') s.remove_prefix(1);
+        return std::from_chars(s.data(), s.data() + s.size(), d).ec == std::errc();
+#else
+        // strtod requires a terminated string
+        const std::string str(s);
+        char* pEnd = nullptr;
+        d = strtod(str.c_str(), &pEnd);
+        return !str.empty() && pEnd == str.c_str() + str.size();
+#endif
+    }
+    
+    /// Numeric value of a list item, as per the column's data type
+    static double GetNumValue (const ListItem& item, DataTypeTy _dataType)
+    {
+        return _dataType == DTY_DOUBLE ? item.GetD() : double(item.GetI());
+    }
+    
+    /// Folding of the Latin-1 supplement letters U+00C0..U+00FF to lower-case base letters, `nullptr` = keep as is
+    static const char* LATIN1_FOLD[64] = {
+        "a", "a", "a", "a", "a", "a", "ae","c", "e", "e", "e", "e", "i", "i", "i", "i",     // U+00C0..U+00CF
+        "d", "n", "o", "o", "o", "o", "o", nullptr, "o", "u", "u", "u", "u", "y", "th","ss",// U+00D0..U+00DF
+        "a", "a", "a", "a", "a", "a", "ae","c", "e", "e", "e", "e", "i", "i", "i", "i",     // U+00E0..U+00EF
+        "d", "n", "o", "o", "o", "o", "o", nullptr, "o", "u", "u", "u", "u", "y", "th","y", // U+00F0..U+00FF
+    };
+    
+    // Computes a collation key
+    std::string MakeCollationKey (const std::string& _s, CollationTy _coll)
+    {
+        std::string key;
+        switch (_coll) {
+            case COLL_BINARY:
+                return _s;
+                
+            case COLL_LOCALE:
+            {
+                // let the C library compute a key, which compares with strcmp
+                key.resize(std::strxfrm(nullptr, _s.c_str(), 0));
+                if (!key.empty())
+                    std::strxfrm(&key[0], _s.c_str(), key.size()+1);
+                return key;
+            }
+                
+            case COLL_NOCASE:
+            case COLL_NATURAL:
+                key.reserve(_s.size() + 4);
+                for (size_t i = 0; i < _s.size(); i++) {
+                    const unsigned char c = (unsigned char)_s[i];
+                    // A run of digits in natural sorting: Compare by length first, then by digits.
+                    // The key gets a '0' as marker (so that numbers sort before letters),
+                    // followed by the number of digits and then the digits without leading zeros
+                    if (_coll == COLL_NATURAL && std::isdigit(c)) {
+                        size_t end = i;
+                        while (end < _s.size() && std::isdigit((unsigned char)_s[end]))
+                            end++;
+                        while (i+1 < end && _s[i] == '0')
+                            i++;
+                        key += '0';
+                        key += char(std::min<size_t>(end-i, 0xFF));
+                        key.append(_s, i, end-i);
+                        i = end-1;
+                    }
+                    // UTF-8 encoded Latin-1 supplement letter: fold to its base letter
+                    else if (c == 0xC3 && i+1 < _s.size() &&
+                             (unsigned char)_s[i+1] >= 0x80 && (unsigned char)_s[i+1] <= 0xBF &&
+                             LATIN1_FOLD[(unsigned char)_s[i+1] - 0x80])
+                    {
+                        key += LATIN1_FOLD[(unsigned char)_s[++i] - 0x80];
+                    }
+                    // ASCII: lower case
+                    else if (c < 0x80)
+                        key += char(std::tolower(c));
+                    // anything else is taken as is
+                    else
+                        key += char(c);
+                }
+                return key;
+        }
+        return _s;
+    }
+    
+#if APL
+    /// @brief `CGEventSourceFlagsState`, resolved at runtime, so that we don't need to include and link CoreGraphics
+    /// @see https://developer.apple.com/documentation/coregraphics/1408761-cgeventsourceflagsstate
+    typedef uint64_t (*CGEventSourceFlagsStateFn)(int32_t);
+    constexpr int32_t  CG_STATE_COMBINED_SESSION = 0;       ///< kCGEventSourceStateCombinedSessionState
+    constexpr uint64_t CG_FLAG_SHIFT    = 0x00020000;       ///< kCGEventFlagMaskShift
+    constexpr uint64_t CG_FLAG_CONTROL  = 0x00040000;       ///< kCGEventFlagMaskControl
+    constexpr uint64_t CG_FLAG_ALT      = 0x00080000;       ///< kCGEventFlagMaskAlternate
+    constexpr uint64_t CG_FLAG_COMMAND  = 0x00100000;       ///< kCGEventFlagMaskCommand
+#elif LIN
+    /// @brief Xlib functions, resolved at runtime from the `libX11` X-Plane has loaded, so that we don't need to link it
+    /// @see https://www.x.org/releases/current/doc/libX11/libX11/libX11.html#XQueryKeymap
+    static struct X11FuncsTy {
+        bool bResolved = false;             ///< tried resolving already?
+        void* display = nullptr;            ///< our own connection to the X server, `nullptr` if not available
+        int (*queryKeymap)(void*, char[32]) = nullptr;
+        unsigned char kcShift[2]   = {0,0}; ///< key codes of left/right Shift
+        unsigned char kcControl[2] = {0,0}; ///< key codes of left/right Control
+        unsigned char kcAlt[2]     = {0,0}; ///< key codes of left/right Alt
+    } gX11;
+    
+    /// Open a connection to the X server and look up the modifiers' key codes
+    static void X11Resolve ()
+    {
+        gX11.bResolved = true;
+        void* lib = dlopen("libX11.so.6", RTLD_LAZY);
+        if (!lib)
+            return;
+        void* (*openDisplay)(const char*) =
+            reinterpret_cast<void*(*)(const char*)>(dlsym(lib, "XOpenDisplay"));
+        unsigned char (*keysymToKeycode)(void*, unsigned long) =
+            reinterpret_cast<unsigned char(*)(void*, unsigned long)>(dlsym(lib, "XKeysymToKeycode"));
+        gX11.queryKeymap = reinterpret_cast<int(*)(void*, char[32])>(dlsym(lib, "XQueryKeymap"));
+        if (!openDisplay || !keysymToKeycode || !gX11.queryKeymap ||
+            !(gX11.display = openDisplay(nullptr)))
+            return;
+        // XK_Shift_L/R, XK_Control_L/R, XK_Alt_L/R
+        gX11.kcShift[0]   = keysymToKeycode(gX11.display, 0xffe1);
+        gX11.kcShift[1]   = keysymToKeycode(gX11.display, 0xffe2);
+        gX11.kcControl[0] = keysymToKeycode(gX11.display, 0xffe3);
+        gX11.kcControl[1] = keysymToKeycode(gX11.display, 0xffe4);
+        gX11.kcAlt[0]     = keysymToKeycode(gX11.display, 0xffe9);
+        gX11.kcAlt[1]     = keysymToKeycode(gX11.display, 0xffea);
+    }
+#endif
+    
+    // Modifier keys currently held down
+    XPLMKeyFlags GetModifierKeys ()
+    {
+        XPLMKeyFlags flags = 0;
+#if IBM
+        if (GetKeyState(VK_SHIFT) & 0x8000)     flags |= xplm_ShiftFlag;
+        if (GetKeyState(VK_CONTROL) & 0x8000)   flags |= xplm_ControlFlag;
+        if (GetKeyState(VK_MENU) & 0x8000)      flags |= xplm_OptionAltFlag;
+#elif APL
+        static CGEventSourceFlagsStateFn flagsState =
+            reinterpret_cast<CGEventSourceFlagsStateFn>(dlsym(RTLD_DEFAULT, "CGEventSourceFlagsState"));
+        if (flagsState) {
+            const uint64_t cg = flagsState(CG_STATE_COMBINED_SESSION);
+            if (cg & CG_FLAG_SHIFT)                         flags |= xplm_ShiftFlag;
+            // like X-Plane, we take Command as Control
+            if (cg & (CG_FLAG_CONTROL | CG_FLAG_COMMAND))   flags |= xplm_ControlFlag;
+            if (cg & CG_FLAG_ALT)                           flags |= xplm_OptionAltFlag;
+        }
+#elif LIN
+        if (!gX11.bResolved)
+            X11Resolve();
+        char keys[32] = {0};
+        if (gX11.display && gX11.queryKeymap(gX11.display, keys)) {
+            // is any of the two key codes pressed? (key code 0 means "no such key")
+            auto isDown = [&keys](const unsigned char kc[2])
+            {
+                for (int i = 0; i < 2; i++)
+                    if (kc[i] && (keys[kc[i] / 8] & (1 << (kc[i] % 8))))
+                        return true;
+                return false;
+            };
+            if (isDown(gX11.kcShift))       flags |= xplm_ShiftFlag;
+            if (isDown(gX11.kcControl))     flags |= xplm_ControlFlag;
+            if (isDown(gX11.kcAlt))         flags |= xplm_OptionAltFlag;
+        }
+#endif
+        return flags;
+    }
+    
+    /// Index of the lowest set bit, `_w` must not be 0
+    static unsigned CountTrailingZeros (uint64_t _w)
+    {
+#if IBM && defined(_MSC_VER)
+        unsigned long idx = 0;
+        _BitScanForward64(&idx, _w);
+        return unsigned(idx);
+#else
+        return unsigned(__builtin_ctzll(_w));
+#endif
+    }
+    
     // Sets current value to a double value
     void ListItem::Set (double _d, int _prec)
     {
         snprintf(lbBuf, sizeof(lbBuf), "%.*f", _prec, dVal = _d);
         sVal = lbBuf;
+        keyColl = COLL_BINARY;
+    }
+    
+    // Makes sure the collation key for `_coll` is available
+    void ListItem::UpdateKey (CollationTy _coll)
+    {
+        // Binary collation doesn't need a key, and if computed already we are done
+        if (_coll == COLL_BINARY || _coll == keyColl)
+            return;
+        sKey = MakeCollationKey(sVal.full(), _coll);
+        keyColl = _coll;
+    }
+    
+    // Reset to an empty value, keeping the string storage
+    void ListItem::Clear ()
+    {
+        sVal.clear();
+        iVal = 0;
+        dVal = 0.0;
+        bEnabled = true;
+        keyColl = COLL_BINARY;
+        sKey.clear();
+        measWidth = -1;
+        style = rowStyle = 0;
+        std::fill(std::begin(col), std::end(col), NAN);
+        col[3] = 0.0f;
     }
     
     // compare function, used for sorting
@@ -1250,6 +1790,10 @@ namespace TFW {
     {
         switch(_dataType) {
             case DTY_STRING:
+                // both have a key of the same collation? Then compare keys
+                if (keyColl != COLL_BINARY && keyColl == o.keyColl)
+                    return sKey < o.sKey ? true :
+                    sKey == o.sKey ? _thisBeforeOnEqual : false;
                 return sVal < o.sVal ? true :
                 sVal == o.sVal ? _thisBeforeOnEqual : false;
             case DTY_CHECKBOX:
@@ -1270,6 +1814,13 @@ namespace TFW {
     refCon(_refCon)
     {}
     
+    // Constructor creates a row, taking over the field values
+    ListRow::ListRow (void* _refCon,
+                      std::vector<ListItem>&& _fields) :
+    std::vector<ListItem>(std::move(_fields)),
+    refCon(_refCon)
+    {}
+    
     
     // compare function on any element, used for sorting
     bool ListRow::elemLess (const ListRow& o,
@@ -1290,6 +1841,139 @@ namespace TFW {
     }
     
     
+    // Does the value meet the condition?
+    bool ListFormatRule::Matches (const ListItem& item, DataTypeTy _dataType) const
+    {
+        // string columns compare with the rule's string, others numerically
+        int cmp = 0;
+        if (_dataType == DTY_STRING) {
+            cmp = item.GetS().compare(sVal);
+        } else {
+            const double v = GetNumValue(item, _dataType);
+            if (cond == FMT_RANGE)
+                return val <= v && v < valTo;
+            cmp = v < val ? -1 : v > val ? 1 : 0;
+        }
+        
+        switch (cond) {
+            case FMT_LESS:          return cmp <  0;
+            case FMT_LESS_EQUAL:    return cmp <= 0;
+            case FMT_GREATER:       return cmp >  0;
+            case FMT_GREATER_EQUAL: return cmp >= 0;
+            case FMT_EQUAL:         return cmp == 0;
+            case FMT_NOT_EQUAL:     return cmp != 0;
+            default:                return false;
+        }
+    }
+    
+    
+    /// Neumaier summation: add `_v` to `_sum`, collecting the low-order bits lost in `_comp`
+    static void CompensatedAdd (double& _sum, double& _comp, double _v)
+    {
+        const double t = _sum + _v;
+        if (std::abs(_sum) >= std::abs(_v))
+            _comp += (_sum - t) + _v;
+        else
+            _comp += (_v - t) + _sum;
+        _sum = t;
+    }
+    
+    // Add a value to the aggregate statistics, non-finite values don't count
+    /// NaN would break the multiset's ordering, and infinities would turn the sum into NaN upon removal
+    void ListColumnDef::AggAdd (double _v)
+    {
+        if (!std::isfinite(_v))
+            return;
+        aggVals.insert(_v);
+        CompensatedAdd(aggSum, aggComp, _v);
+    }
+    
+    // Remove a value from the aggregate statistics
+    bool ListColumnDef::AggRemove (double _v)
+    {
+        if (!std::isfinite(_v))
+            return true;                        // was never added
+        std::multiset<double>::iterator iter = aggVals.find(_v);
+        if (iter == aggVals.end())
+            return false;
+        aggVals.erase(iter);
+        // no values, no sum: start over without any accumulated rounding errors
+        if (aggVals.empty())
+            aggSum = aggComp = 0.0;
+        else
+            CompensatedAdd(aggSum, aggComp, -_v);
+        return true;
+    }
+    
+    // Forget the aggregate statistics
+    void ListColumnDef::AggReset ()
+    {
+        bAggStats = false;
+        aggVals.clear();
+        aggSum = aggComp = 0.0;
+    }
+    
+    
+    /// Lowest set bit of `_i`, the length of the range a Fenwick tree node covers
+    static inline size_t LowBit (size_t _i) { return _i & (~_i + 1); }
+    
+    // Rebuild from the given values in `O(n)`
+    void PrefixSumTree::assign (const std::vector<int>& _vals)
+    {
+        tree.assign(_vals.size() + 1, 0);
+        for (size_t i = 1; i < tree.size(); i++) {
+            tree[i] += _vals[i-1];
+            // pass on the node's sum to its parent
+            const size_t parent = i + LowBit(i);
+            if (parent < tree.size())
+                tree[parent] += tree[i];
+        }
+    }
+    
+    // Append a value
+    void PrefixSumTree::push_back (int _v)
+    {
+        if (tree.empty())
+            tree.push_back(0);
+        // the new node covers the new value and some values before
+        const size_t i = tree.size();
+        tree.push_back(_v + prefix(i-1) - prefix(i - LowBit(i)));
+    }
+    
+    // Add `_delta` to the value at index `_i`
+    void PrefixSumTree::add (size_t _i, int _delta)
+    {
+        for (size_t i = _i + 1; i < tree.size(); i += LowBit(i))
+            tree[i] += _delta;
+    }
+    
+    // Sum of the first `_n` values
+    int PrefixSumTree::prefix (size_t _n) const
+    {
+        int sum = 0;
+        for (size_t i = std::min(_n, size()); i > 0; i -= LowBit(i))
+            sum += tree[i];
+        return sum;
+    }
+    
+    // Index of the value, within which the running sum reaches beyond `_sum`
+    /// Descends the tree from the largest power of 2, requires non-negative values
+    size_t PrefixSumTree::find (int _sum) const
+    {
+        size_t pos = 0;
+        size_t step = 1;
+        while (step * 2 <= size())
+            step *= 2;
+        for (; step > 0; step /= 2) {
+            if (pos + step < tree.size() && tree[pos + step] <= _sum) {
+                pos += step;
+                _sum -= tree[pos];
+            }
+        }
+        return pos;
+    }
+    
+    
     // constructor adds widget to main window
     /// @param lR left positioning rule
     /// @param lO offset for left pos
@@ -1311,37 +1995,139 @@ namespace TFW {
     // Adds or overwrites a column definition
     void ListBox::AddCol (unsigned colId, ListColumnDef&& def)
     {
-        // extend vector to needed size
-        if (colId >= cols.size())
-            cols.resize(colId+1);
+        // extend vector to needed size, new columns are displayed at the end
+        while (colId >= cols.size()) {
+            colOrder.push_back(unsigned(cols.size()));
+            cols.emplace_back();
+        }
         
         // set the element as passed in
         // (if this throws an exception then the code above for
         //  vector resizing is wrong, not supposed to happen!)
         cols.at(colId) = std::move(def);
+        bColGeoDirty = true;
+        SetDirty();
+    }
+    
+    // Announce that a column definition was changed via GetCol()
+    bool ListBox::SetColChanged (unsigned colId)
+    {
+        if (colId >= cols.size())
+            return false;
+        bColGeoDirty = true;
+        SetDirty();
+        return true;
     }
     
+    // Set a column's width
+    /// An explicitly set width ends auto width
+    void ListBox::SetColWidth (unsigned colId, int _w)
+    {
+        ListColumnDef& def = cols.at(colId);
+        def.width = _w;
+        def.bAutoWidth = false;
+        bColGeoDirty = true;
+        SetDirty();
+    }
     
-    // Define sorting, will immediately resort the available data
-    void ListBox::SetSorting (unsigned _col, SortingTy _sorted)
+    // Let a column's width follow its widest value
+    void ListBox::SetColAutoWidth (unsigned colId, bool _bAuto)
     {
-        // Special case unsupported
-        if (_sorted == SORT_UNSUPPORTED)
-            _col = 0;
-        
-        // short-cut for "no change"
-        if (sortedBy == _col && sorted == _sorted)
+        cols.at(colId).bAutoWidth = _bAuto;
+        bColGeoDirty = true;
+        SetDirty();
+    }
+    
+    // Show/hide a column
+    void ListBox::SetColVisible (unsigned colId, bool _bVisible)
+    {
+        cols.at(colId).bVisible = _bVisible;
+        bColGeoDirty = true;
+        SetDirty();
+    }
+    
+    // Freeze leading columns
+    void ListBox::SetFrozenCols (size_t _n)
+    {
+        if (colFrozen == _n)
+            return;
+        colFrozen = _n;
+        SetDirty();
+        // validates the horizontal scroll position and crops texts
+        SetFirstCol(colFirst);
+    }
+    
+    // Move a column to another display position
+    void ListBox::MoveCol (unsigned colId, size_t _visIdx)
+    {
+        UpdateColGeometry();
+        std::vector<unsigned>::iterator iter = std::find(colOrder.begin(), colOrder.end(), colId);
+        if (iter == colOrder.end())
             return;
         
-        // check _col is valid
-        if (_col >= cols.size() ||
-            cols.at(_col).dataType == DTY_NULL)
+        // the column, before which we are to insert, or none if at the end
+        const bool bAtEnd = _visIdx >= colVis.size();
+        const unsigned beforeId = bAtEnd ? 0 : colVis[_visIdx];
+        if (!bAtEnd && beforeId == colId)       // no change
             return;
         
-        // save new values and re-sort the rows
-        sortedBy = _col;
-        sorted = _sorted;
-        DoSort();
+        // just permute the order of ids, no row data is touched
+        colOrder.erase(iter);
+        colOrder.insert(bAtEnd ? colOrder.end() :
+                        std::find(colOrder.begin(), colOrder.end(), beforeId),
+                        colId);
+        bColGeoDirty = true;
+        SetDirty();
+    }
+    
+    // Scroll horizontally so that the given visible column is the first shown
+    void ListBox::SetFirstCol (size_t _visIdx)
+    {
+        UpdateColGeometry();
+        if (colVis.empty()) {
+            colFirst = 0;
+            return;
+        }
+        const size_t prevFirst = colFirst;
+        
+        // Don't scroll further right than needed to fully show the last column:
+        // The first column to show needs to start at or after `overflow`,
+        // which increases by the space taken by frozen columns
+        const size_t frozenEnd = GetFrozenEnd();
+        const int overflow = colRight.back() - GetColAreaWidth() + GetFrozenWidth();
+        const size_t maxFirst = overflow <= GetFrozenWidth() ? frozenEnd :
+        std::min(size_t(std::lower_bound(colRight.begin(), colRight.end(), overflow) - colRight.begin()) + 1,
+                 colVis.size() - 1);
+        colFirst = std::max(std::min(_visIdx, maxFirst), frozenEnd);
+        if (colFirst != prevFirst)
+            SetDirty();
+        
+        // Another set of columns is now visible, which might need cropping
+        DoCropTexts();
+    }
+    
+    
+    // Define sorting, will immediately resort the available data
+    void ListBox::SetSorting (unsigned _col, SortingTy _sorted)
+    {
+        // Special case unsupported
+        if (_sorted == SORT_UNSUPPORTED)
+            _col = 0;
+        
+        // short-cut for "no change"
+        if (sortedBy == _col && sorted == _sorted)
+            return;
+        
+        // check _col is valid
+        if (_col >= cols.size() ||
+            cols.at(_col).dataType == DTY_NULL)
+            return;
+        
+        // save new values and re-sort the rows
+        sortedBy = _col;
+        sorted = _sorted;
+        SetDirty();
+        DoSort();
     }
     
     
@@ -1365,16 +2151,9 @@ namespace TFW {
         if (rowMax > 0) --rowMax;
         
         // Maybe we got resized since last drawing, so let's check if we need
-        // to adapt scroll position
-        if (rows.size() <= rowMax) {
-            rowFirst = rowFirstMaxDown = 0;           // no issue, all rows fit
-        }
-        else {
-            // what would be the first row to show when fully scrolled down?
-            rowFirstMaxDown = unsigned(rows.size()) - rowMax;
-            if (rowFirst > rowFirstMaxDown)
-                rowFirst = rowFirstMaxDown;
-        }
+        // to adapt scroll position (the line height might have changed, too)
+        bRowTopsDirty = true;
+        DoScrollTo(scrollY);
         
         // we might need to crop strings in the last visible column
         DoCropTexts();
@@ -1384,30 +2163,290 @@ namespace TFW {
     }
     
     
+    // Scroll vertically to a position in boxels, stops any scrolling inertia
+    void ListBox::SetScrollPos (int _y)
+    {
+        const int prevY = scrollY;
+        scrollVel = scrollRemain = 0.0f;
+        DoScrollTo(_y);
+        if (scrollY != prevY)
+            SetDirty();
+    }
+    
+    
     // Add an actual row to the list box, which is to be displayed
     ListRow& ListBox::AddRow (ListRow&& row)
     {
+        // compute collation keys of the new values
+        DoUpdateKeys(row);
+        
         // first we check for duplicates
         ListRowVecTy::iterator iter;
         if (FindRowIdx(row.refCon, iter)) {
             // found, so overwrite existing data, but re-use same `sequNr`
             row.SetSequNr(iter->GetSequNr());
-            *iter = std::move(row);
+            row.slot = iter->slot;
+            row.level = iter->level;
+            DoUnindexRow(*iter);
+            const int oldHeight = GetRowHeight(*iter);
+            // swap instead of move-assign, so that the old row's storage can be reused
+            std::swap(*iter, row);
+            RetireRow(std::move(row));
+            // the row's height might have changed
+            if (!bRowTopsDirty)
+                rowTops.add(size_t(iter - rows.begin()), GetRowHeight(*iter) - oldHeight);
         } else {
             // not found, new data to be added:
-            // set the always increasing sequence number to this row
-            row.SetSequNr(++sequRow);
+            // set the always increasing sequence number and a slot for selection
+            DoAdoptRow(row);
             // add the row to the end of the row vector
             rows.emplace_back(std::move(row));
             iter = std::prev(rows.end());
+            // appending to the height index is cheap, if it is up-to-date
+            if (!bRowTopsDirty && rowTops.size() + 1 == rows.size())
+                rowTops.push_back(GetRowHeight(*iter));
+            else
+                bRowTopsDirty = true;
         }
-        // if sorting is other than none: re-sort
-        if (sorted > SORT_UNSORTED)
+        // account for the new values' widths
+        DoIndexRow(*iter);
+        bTypeIdxDirty = true;
+        SetDirty();
+        // if sorting is other than none: re-sort,
+        // after which the row is likely at a different position
+        if (sorted > SORT_UNSORTED) {
+            void* const refCon = iter->refCon;
             DoSort();
+            FindRowIdx(refCon, iter);
+        }
         // return reference to the row
         return *iter;
     }
     
+    // Get an empty row to be filled and passed to AddRow()
+    ListRow ListBox::ObtainRow (void* _refCon)
+    {
+        if (rowPool.empty()) {
+            // a new row gets one block, which fits a value for each column
+            ListRow row (_refCon);
+            row.reserve(cols.size());
+            return row;
+        }
+        
+        // reuse a retired row, its values keep their storage
+        ListRow row (std::move(rowPool.back()));
+        rowPool.pop_back();
+        row.refCon = _refCon;
+        row.sequNr = row.slot = row.level = row.height = 0;
+        row.style = 0;
+        for (ListItem& item: row)
+            item.Clear();
+        if (row.capacity() < cols.size())
+            row.reserve(cols.size());
+        return row;
+    }
+    
+    // Add/update many rows at once
+    void ListBox::AddRows (ListRowVecTy&& newRows)
+    {
+        // index of all existing rows for finding duplicates
+        std::unordered_map<void*,size_t> idx;
+        idx.reserve(rows.size() + newRows.size());
+        for (size_t i = 0; i < rows.size(); i++)
+            idx.emplace(rows[i].refCon, i);
+        
+        rows.reserve(rows.size() + newRows.size());
+        for (ListRow& row: newRows) {
+            DoUpdateKeys(row);
+            std::unordered_map<void*,size_t>::iterator iter = idx.find(row.refCon);
+            if (iter != idx.end()) {
+                // found, so overwrite existing data, see AddRow()
+                ListRow& old = rows[iter->second];
+                row.SetSequNr(old.GetSequNr());
+                row.slot = old.slot;
+                row.level = old.level;
+                DoUnindexRow(old);
+                std::swap(old, row);
+                RetireRow(std::move(row));
+                DoIndexRow(old);
+            } else {
+                DoAdoptRow(row);
+                idx.emplace(row.refCon, rows.size());
+                rows.emplace_back(std::move(row));
+                DoIndexRow(rows.back());
+            }
+        }
+        newRows.clear();
+        bRowTopsDirty = true;
+        bTypeIdxDirty = true;
+        SetDirty();
+        
+        // sort once for all rows
+        if (sorted > SORT_UNSORTED)
+            DoSort();
+    }
+    
+    // Import rows from a delimited text file
+    size_t ListBox::ImportDelimited (const std::string& _path,
+                                     char _delim,
+                                     bool _bHeader,
+                                     std::vector<unsigned> _colIds,
+                                     std::function<void*(const ListRow&)> _refConFn)
+    {
+        MappedFile file(_path);
+        if (!file.data)
+            return 0;
+        const char* p = file.data;
+        const char* const end = file.data + file.size;
+        
+        // header line: match fields to columns by name
+        if (_bHeader) {
+            const char* eol = (const char*)memchr(p, '\n', size_t(end - p));
+            if (!eol) eol = end;
+            if (_colIds.empty()) {
+                std::string quoted;
+                std::string_view field;
+                bool bAnyMatch = false;
+                for (const char* f = p; ; ) {
+                    f = NextField(f, eol, _delim, quoted, field);
+                    field = TrimField(field);
+                    if (!field.empty() && field.back() == '\r')
+                        field.remove_suffix(1);
+                    unsigned colId = UINT_MAX;
+                    for (unsigned c = 0; c < cols.size(); c++)
+                        if (cols[c].dataType != DTY_NULL && cols[c].name.full() == field) {
+                            colId = c;
+                            bAnyMatch = true;
+                            break;
+                        }
+                    _colIds.push_back(colId);
+                    if (f >= eol) break;
+                }
+                // no header matched any column? Then go by position
+                if (!bAnyMatch)
+                    _colIds.clear();
+            }
+            p = eol < end ? eol + 1 : end;
+        }
+        // by default, fields go to columns by position
+        if (_colIds.empty())
+            for (unsigned c = 0; c < cols.size(); c++)
+                _colIds.push_back(c);
+        
+        // split into chunks at line starts, one per thread
+        const size_t numThreads = std::max<size_t>(1,
+            std::min<size_t>(std::thread::hardware_concurrency(),
+                             size_t(end - p) / IMPORT_MIN_CHUNK + 1));
+        std::vector<const char*> bounds = { p };
+        for (size_t t = 1; t < numThreads; t++) {
+            const char* b = std::max(bounds.back(), p + size_t(end - p) * t / numThreads);
+            const char* eol = (const char*)memchr(b, '\n', size_t(end - b));
+            if (eol)
+                bounds.push_back(eol + 1);
+        }
+        bounds.push_back(end);
+        
+        // parse the chunks in parallel, the first one in this thread
+        std::vector<std::vector<ImportRowTy>> chunks (bounds.size() - 1);
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < chunks.size(); t++)
+            workers.emplace_back(&ListBox::DoParseDelimited, this,
+                                 bounds[t], bounds[t+1], _delim, std::cref(_colIds), std::ref(chunks[t]));
+        DoParseDelimited(bounds[0], bounds[1], _delim, _colIds, chunks[0]);
+        for (std::thread& w: workers)
+            w.join();
+        
+        // collect all rows in file order and give them their refCons
+        ListRowVecTy newRows;
+        size_t numRows = 0;
+        for (const std::vector<ImportRowTy>& chunk: chunks)
+            numRows += chunk.size();
+        newRows.reserve(numRows);
+        for (std::vector<ImportRowTy>& chunk: chunks)
+            for (ImportRowTy& vals: chunk) {
+                // the list items are made here in the main thread, the strings are just moved
+                ListRow row (nullptr);
+                row.resize(cols.size());
+                for (unsigned colId = 0; colId < cols.size(); colId++) {
+                    const ListColumnDef& def = cols[colId];
+                    ImportValTy& val = vals[colId];
+                    ListItem& item = row[colId];
+                    switch (def.dataType) {
+                        case DTY_INT:
+                            item = val.bNum ? ListItem(val.i) : ListItem(std::move(val.s));
+                            break;
+                        case DTY_DOUBLE:
+                            // keep the text as in the file, with the value for sorting
+                            item = ListItem(std::move(val.s));
+                            if (val.bNum)
+                                item.dVal = val.d;
+                            break;
+                        case DTY_CHECKBOX:
+                            item = ListItem(val.i != 0);
+                            break;
+                        default:
+                            item = ListItem(std::move(val.s));
+                            if (def.collation != COLL_BINARY) {
+                                item.sKey = std::move(val.key);
+                                item.keyColl = def.collation;
+                            }
+                    }
+                }
+                row.refCon = _refConFn ? _refConFn(row) : (void*)uintptr_t(newRows.size() + 1);
+                newRows.emplace_back(std::move(row));
+            }
+        
+        // one bulk insert with a single sort
+        AddRows(std::move(newRows));
+        return numRows;
+    }
+    
+    // Change a row's height
+    bool ListBox::SetRowHeight (void* _refCon, unsigned _h)
+    {
+        ListRowVecTy::iterator iter;
+        if (!FindRowIdx(_refCon, iter))
+            return false;
+        
+        const int oldHeight = GetRowHeight(*iter);
+        iter->height = _h;
+        SetDirty();
+        if (!bRowTopsDirty)
+            rowTops.add(size_t(iter - rows.begin()), GetRowHeight(*iter) - oldHeight);
+        // total height changed, so maybe the scroll position is no longer valid
+        DoScrollTo(scrollY);
+        return true;
+    }
+    
+    // Change a single value of a row
+    bool ListBox::SetItem (void* _refCon, unsigned colId, ListItem&& item)
+    {
+        ListRowVecTy::iterator iter;
+        if (!FindRowIdx(_refCon, iter))
+            return false;
+        
+        // make room for the value if the row is too short so far
+        if (colId >= iter->size())
+            iter->resize(colId+1);
+        
+        // replace the value, taking care of width histogram and collation key
+        ListItem& rowItem = (*iter)[colId];
+        DoUnindexItem(colId, rowItem);
+        rowItem = std::move(item);
+        if (colId < cols.size() && cols[colId].dataType == DTY_STRING)
+            rowItem.UpdateKey(cols[colId].collation);
+        DoFormatItem(colId, rowItem);
+        DoIndexItem(colId, rowItem);
+        DoUpdateRowStyle(*iter);
+        bTypeIdxDirty = true;
+        SetDirty();
+        
+        // re-sort only if the changed column is the sorting column
+        if (sorted > SORT_UNSORTED && sortedBy == colId)
+            DoSort();
+        return true;
+    }
+    
     // Return row by index (which is unsafe as sorting can change the order)
     ListRow* ListBox::GetRow (size_t index)
     {
@@ -1426,18 +2465,115 @@ namespace TFW {
             return nullptr;
     }
     
+    // Define the aggregate a numeric column shows in the footer row
+    void ListBox::SetColAggregate (unsigned colId, AggregateTy _agg)
+    {
+        cols.at(colId).aggregate = _agg;
+        SetDirty();
+    }
+    
+    // Get an aggregate of a numeric column's values
+    bool ListBox::GetColAggregate (unsigned colId, AggregateTy _agg, double& _val)
+    {
+        if (colId >= cols.size())
+            return false;
+        ListColumnDef& def = cols[colId];
+        if (def.dataType != DTY_INT && def.dataType != DTY_DOUBLE)
+            return false;
+        
+        // First time we need the statistics we have to collect all values once,
+        // from then on they are maintained when adding/changing/removing values
+        if (!def.bAggStats) {
+            def.AggReset();
+            def.bAggStats = true;
+            for (const ListRow& row: rows)
+                if (colId < row.size())
+                    def.AggAdd(GetNumValue(row[colId], def.dataType));
+        }
+        
+        const size_t n = def.aggVals.size();
+        switch (_agg) {
+            case AGG_COUNT: _val = double(n);                   return true;
+            case AGG_SUM:   _val = def.GetAggSum();             return true;
+            case AGG_MIN:   if (!n) return false; _val = *def.aggVals.cbegin();    return true;
+            case AGG_MAX:   if (!n) return false; _val = *def.aggVals.crbegin();   return true;
+            case AGG_MEAN:  if (!n) return false; _val = def.GetAggSum() / double(n); return true;
+            default:        return false;
+        }
+    }
+    
+    // Define a text style to be used by formatting rules
+    uint8_t ListBox::AddStyle (const float _col[4], bool _bBold)
+    {
+        // style indexes are stored in a byte
+        if (styles.size() > UINT8_MAX)
+            return 0;
+        styles.emplace_back();
+        memmove(styles.back().col, _col, sizeof(styles.back().col));
+        styles.back().bBold = _bBold;
+        return uint8_t(styles.size() - 1);
+    }
+    
+    // Add a formatting rule to a column
+    void ListBox::AddFormatRule (unsigned colId, ListFormatRule&& rule)
+    {
+        // unknown styles fall back to the standard style
+        if (rule.style >= styles.size())
+            rule.style = 0;
+        cols.at(colId).fmtRules.emplace_back(std::move(rule));
+        SetDirty();
+        
+        // existing values are evaluated once now
+        for (ListRow& row: rows) {
+            if (colId < row.size())
+                DoFormatItem(colId, row[colId]);
+            DoUpdateRowStyle(row);
+        }
+    }
+    
+    // Remove all formatting rules of a column
+    void ListBox::ClearFormatRules (unsigned colId)
+    {
+        cols.at(colId).fmtRules.clear();
+        SetDirty();
+        for (ListRow& row: rows) {
+            if (colId < row.size())
+                row[colId].style = row[colId].rowStyle = 0;
+            DoUpdateRowStyle(row);
+        }
+    }
+    
+    // Show/hide the footer row with the columns' aggregates
+    void ListBox::SetFooter (bool _b)
+    {
+        if (bFooter == _b)
+            return;
+        bFooter = _b;
+        SetDirty();
+        // the rows have less/more space now
+        DoScrollTo(scrollY);
+    }
+    
     // Remove a row, identified by ListRow::refCon
     bool ListBox::RemoveRow (void* _refCon)
     {
-        ListRowVecTy::const_iterator iter;
+        ListRowVecTy::iterator iter;
         if (FindRowIdx(_refCon, iter))
         {
-            // if it is the selected row, then no row is selected now
+            // if it is the current row, then there is no current row now
             if (selRefCon == iter->refCon)
                 selRefCon = nullptr;
+            if (selAnchor == iter->refCon)
+                selAnchor = nullptr;
             
-            // remove the row
+            // remove the row, which also deselects it
+            FreeSlot(iter->slot);
+            DoUnindexRow(*iter);
+            RetireRow(std::move(*iter));
             rows.erase(iter);
+            bRowTopsDirty = true;
+            bTypeIdxDirty = true;
+            SetDirty();
             return true;
         }
         // not found
@@ -1448,24 +2584,142 @@ namespace TFW {
     // Clear a list: Remove all rows
     void ListBox::Clear ()
     {
-        selRefCon = nullptr;            // no selection any longer
-        rows.clear();                   // remove all rows
+        selRefCon = selAnchor = nullptr;// no selection any longer
+        selBits.clear();
+        selCount = 0;
+        slotRefCon.clear();             // no rows, no slots
+        freeSlots.clear();
+        // remove all rows, keeping up to `rowPoolMax` of them for reuse:
+        // the larger vector becomes the pool, so fewer rows need to be moved
+        if (rowPoolMax > 0 && rowPool.size() < rows.size())
+            rowPool.swap(rows);
+        for (ListRow& row: rows)
+            RetireRow(std::move(row));
+        rows.clear();
+        if (rowPool.size() > rowPoolMax)
+            rowPool.erase(rowPool.begin() + ptrdiff_t(rowPoolMax), rowPool.end());
+        bTypeIdxDirty = true;
+        bRowTopsDirty = true;
+        scrollY = 0;
+        rowFirst = 0;
+        SetDirty();
+        
+        // no values, no widths, no aggregates
+        for (ListColumnDef& def: cols) {
+            def.widthHist.clear();
+            def.aggVals.clear();
+            def.aggSum = def.aggComp = 0.0;
+            if (def.bAutoWidth)
+                bColGeoDirty = true;
+        }
     }
     
     
     // Set selection, returns if the row is available
-    bool ListBox::SelectRow (void* _refCon)
+    bool ListBox::SelectRow (void* _refCon, bool _bAdd)
     {
+        // adding is only possible in multi-selection lists
+        _bAdd = _bAdd && bMultiSel;
+        if (!_bAdd) {
+            if (selCount || selRefCon)
+                SetDirty();
+            ClearSelBits();
+        }
+        
         ListRowVecTy::const_iterator iter;
         if (FindRowIdx(_refCon, iter))
         {
+            SetDirty();
+            SetSelBit(iter->slot, true);
             selRefCon = _refCon;
+            if (!_bAdd || !selAnchor)
+                selAnchor = _refCon;
             return true;
         }
-        selRefCon = nullptr;
+        if (!_bAdd)
+            selRefCon = selAnchor = nullptr;
         return false;
     }
     
+    // Select all rows (multi-selection lists only)
+    void ListBox::SelectAll ()
+    {
+        if (!bMultiSel)
+            return;
+        SetDirty();
+        for (const ListRow& row: rows)
+            SetSelBit(row.slot, true);
+    }
+    
+    // Clear selection
+    void ListBox::SelectNone ()
+    {
+        if (selCount || selRefCon)
+            SetDirty();
+        ClearSelBits();
+        selRefCon = selAnchor = nullptr;
+    }
+    
+    // `refCon`s of all selected rows
+    std::vector<void*> ListBox::GetSelectedRefCons () const
+    {
+        std::vector<void*> ret;
+        ret.reserve(selCount);
+        // skip empty words, then visit the set bits only
+        for (size_t i = 0; i < selBits.size() && ret.size() < selCount; i++)
+            for (uint64_t w = selBits[i]; w; w &= w - 1)
+                ret.push_back(slotRefCon[i*64 + CountTrailingZeros(w)]);
+        return ret;
+    }
+    
+    // Remove all selected rows
+    /// The rows vector is compacted in one pass, moving each remaining row at most once
+    size_t ListBox::RemoveSelected ()
+    {
+        if (!selCount)
+            return 0;
+        
+        const size_t numRemoved = selCount;
+        ListRowVecTy::iterator dst = rows.begin();
+        for (ListRowVecTy::iterator src = rows.begin(); src != rows.end(); ++src) {
+            if (IsSelected(*src)) {
+                if (selRefCon == src->refCon)
+                    selRefCon = nullptr;
+                if (selAnchor == src->refCon)
+                    selAnchor = nullptr;
+                FreeSlot(src->slot);            // also deselects
+                DoUnindexRow(*src);
+                RetireRow(std::move(*src));
+            } else {
+                if (dst != src)
+                    *dst = std::move(*src);
+                ++dst;
+            }
+        }
+        rows.erase(dst, rows.end());
+        bTypeIdxDirty = true;
+        bRowTopsDirty = true;
+        SetDirty();
+        return numRemoved;
+    }
+    
+    
+    // Select the first row, whose value in the search column starts with `_prefix`
+    bool ListBox::SelectByPrefix (const std::string& _prefix)
+    {
+        unsigned colId = 0;
+        if (rows.empty() || !GetTypeAheadCol(colId))
+            return false;
+        
+        ListRowVecTy::iterator iter = FindRowByPrefix(colId, _prefix);
+        if (iter == rows.end())
+            return false;
+        SetDirty();
+        DoSelectRow(*iter);
+        MakeSelVisible();
+        return true;
+    }
+    
     
     // find a row by refCon (const version)
     const ListRow* ListBox::FindRow (void* _refCon) const
@@ -1494,112 +2748,622 @@ namespace TFW {
         // not found
         return nullptr;
     }
+    
+    // Announce that a row was changed via GetRow() or FindRow()
+    /// The previous values are unknown, so the aggregates are collected anew when needed.
+    /// The previous widths are known per value, so the width histograms are updated right away.
+    bool ListBox::SetRowChanged (void* _refCon)
+    {
+        ListRowVecTy::iterator iter;
+        if (!FindRowIdx(_refCon, iter))
+            return false;
+        for (ListColumnDef& def: cols)
+            if (def.bAggStats)
+                def.AggReset();
+        DoUnindexRow(*iter);
+        DoUpdateKeys(*iter);
+        DoIndexRow(*iter);
+        bTypeIdxDirty = true;
+        bRowTopsDirty = true;               // its height might have changed
+        SetDirty();
+        return true;
+    }
 
     
+    // Save column definitions, rows, and sorting state to a binary snapshot file
+    bool ListBox::SaveSnapshot (const std::string& _path) const
+    {
+        // intern all strings: column headers and values
+        std::vector<const std::string*> strs;
+        std::unordered_map<std::string,uint32_t> strIdx;
+        auto intern = [&strs,&strIdx](const std::string& s) -> uint32_t
+        {
+            std::pair<std::unordered_map<std::string,uint32_t>::iterator,bool> ins =
+            strIdx.emplace(s, uint32_t(strs.size()));
+            if (ins.second)
+                strs.push_back(&ins.first->first);
+            return ins.first->second;
+        };
+        
+        const uint32_t numCols = uint32_t(cols.size());
+        const uint32_t numRows = uint32_t(rows.size());
+        
+        // layout of the sections
+        SnapHeaderTy hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, SNAP_MAGIC, sizeof(hdr.magic));
+        hdr.byteOrder   = SNAP_BYTE_ORDER;
+        hdr.version     = SNAP_VERSION;
+        hdr.numCols     = numCols;
+        hdr.numRows     = numRows;
+        hdr.sortedBy    = sortedBy;
+        hdr.sorted      = int32_t(sorted);
+        hdr.ofsCols     = SnapAlign(sizeof(SnapHeaderTy));
+        hdr.ofsOrder    = SnapAlign(hdr.ofsCols + numCols * sizeof(SnapColTy));
+        hdr.ofsRows     = SnapAlign(hdr.ofsOrder + numCols * sizeof(uint32_t));
+        hdr.ofsCells    = SnapAlign(hdr.ofsRows + numRows * sizeof(SnapRowTy));
+        uint64_t ofs = hdr.ofsCells;
+        for (const ListColumnDef& def: cols)
+            ofs += SnapCellsSize(uint8_t(def.dataType), numRows);
+        hdr.ofsStrOfs   = ofs;
+        
+        // everything up to the string table goes into one buffer
+        std::vector<char> buf(size_t(hdr.ofsStrOfs), 0);
+        
+        // columns and their order
+        SnapColTy* pCol = reinterpret_cast<SnapColTy*>(buf.data() + hdr.ofsCols);
+        for (const ListColumnDef& def: cols) {
+            pCol->nameIdx       = intern(def.name.full());
+            pCol->width         = def.width;
+            pCol->dataType      = uint8_t(def.dataType);
+            pCol->bVisible      = def.bVisible;
+            pCol->collation     = uint8_t(def.collation);
+            pCol->bAutoWidth    = def.bAutoWidth;
+            pCol->aggregate     = uint8_t(def.aggregate);
+            ++pCol;
+        }
+        std::copy(colOrder.begin(), colOrder.end(),
+                  reinterpret_cast<uint32_t*>(buf.data() + hdr.ofsOrder));
+        
+        // rows, in display order
+        SnapRowTy* pRow = reinterpret_cast<SnapRowTy*>(buf.data() + hdr.ofsRows);
+        for (const ListRow& row: rows) {
+            pRow->refCon    = uint64_t(uintptr_t(row.refCon));
+            pRow->sequNr    = row.sequNr;
+            pRow->height    = row.height;
+            ++pRow;
+        }
+        
+        // cells, column by column
+        ofs = hdr.ofsCells;
+        for (unsigned colId = 0; colId < numCols; colId++) {
+            const DataTypeTy dt = cols[colId].dataType;
+            uint32_t* pStr = reinterpret_cast<uint32_t*>(buf.data() + ofs);
+            int32_t*  pInt = reinterpret_cast<int32_t*>(buf.data() + ofs + SnapAlign(numRows * sizeof(uint32_t)));
+            double*   pDbl = reinterpret_cast<double*>(pInt);
+            for (uint32_t r = 0; r < numRows; r++) {
+                if (colId >= rows[r].size()) {
+                    pStr[r] = SNAP_NO_VALUE;
+                    continue;
+                }
+                const ListItem& item = rows[r][colId];
+                pStr[r] = intern(item.GetS());
+                if (dt == DTY_INT || dt == DTY_CHECKBOX)
+                    pInt[r] = int32_t(item.iVal);
+                else if (dt == DTY_DOUBLE)
+                    pDbl[r] = item.dVal;
+            }
+            ofs += SnapCellsSize(uint8_t(dt), numRows);
+        }
+        
+        // string table: offsets, then the concatenated strings
+        hdr.numStrings  = uint32_t(strs.size());
+        std::vector<uint32_t> strOfs;
+        strOfs.reserve(strs.size() + 1);
+        uint32_t strSize = 0;
+        for (const std::string* s: strs) {
+            strOfs.push_back(strSize);
+            strSize += uint32_t(s->size());
+        }
+        strOfs.push_back(strSize);
+        hdr.ofsStrData  = hdr.ofsStrOfs + strOfs.size() * sizeof(uint32_t);
+        hdr.fileSize    = hdr.ofsStrData + strSize;
+        memcpy(buf.data(), &hdr, sizeof(hdr));
+        
+        // write it all
+        std::ofstream f(_path, std::ios::binary | std::ios::trunc);
+        if (!f)
+            return false;
+        f.write(buf.data(), std::streamsize(buf.size()));
+        f.write(reinterpret_cast<const char*>(strOfs.data()), std::streamsize(strOfs.size() * sizeof(uint32_t)));
+        for (const std::string* s: strs)
+            f.write(s->data(), std::streamsize(s->size()));
+        return bool(f);
+    }
+    
+    // Replace columns and rows by a snapshot saved with SaveSnapshot()
+    bool ListBox::LoadSnapshot (const std::string& _path)
+    {
+        MappedFile file(_path);
+        if (!file.data || file.size < sizeof(SnapHeaderTy))
+            return false;
+        
+        // validate the header and that all sections are within the file
+        const SnapHeaderTy& hdr = *reinterpret_cast<const SnapHeaderTy*>(file.data);
+        if (memcmp(hdr.magic, SNAP_MAGIC, sizeof(hdr.magic)) != 0 ||
+            hdr.byteOrder != SNAP_BYTE_ORDER ||
+            hdr.version != SNAP_VERSION ||
+            hdr.fileSize != file.size ||
+            hdr.ofsCols  < sizeof(SnapHeaderTy) ||
+            hdr.ofsOrder < hdr.ofsCols  + uint64_t(hdr.numCols) * sizeof(SnapColTy) ||
+            hdr.ofsRows  < hdr.ofsOrder + uint64_t(hdr.numCols) * sizeof(uint32_t) ||
+            hdr.ofsCells < hdr.ofsRows  + uint64_t(hdr.numRows) * sizeof(SnapRowTy) ||
+            hdr.ofsStrData < hdr.ofsStrOfs + (uint64_t(hdr.numStrings) + 1) * sizeof(uint32_t) ||
+            hdr.ofsStrData > hdr.fileSize ||
+            (hdr.ofsCols | hdr.ofsOrder | hdr.ofsRows | hdr.ofsCells | hdr.ofsStrOfs) % 8)
+            return false;
+        const SnapColTy* sCols  = reinterpret_cast<const SnapColTy*>(file.data + hdr.ofsCols);
+        const uint32_t*  sOrder = reinterpret_cast<const uint32_t*>(file.data + hdr.ofsOrder);
+        const SnapRowTy* sRows  = reinterpret_cast<const SnapRowTy*>(file.data + hdr.ofsRows);
+        const uint32_t*  strOfs = reinterpret_cast<const uint32_t*>(file.data + hdr.ofsStrOfs);
+        const char*      strData = file.data + hdr.ofsStrData;
+        const uint64_t   strSize = hdr.fileSize - hdr.ofsStrData;
+        
+        // cells need to end where the string table begins
+        std::vector<uint64_t> cellOfs;
+        cellOfs.reserve(hdr.numCols);
+        uint64_t ofs = hdr.ofsCells;
+        for (uint32_t c = 0; c < hdr.numCols; c++) {
+            if (sCols[c].dataType > DTY_DOUBLE || sCols[c].collation > COLL_LOCALE ||
+                sCols[c].aggregate > AGG_MEAN)
+                return false;
+            cellOfs.push_back(ofs);
+            ofs += SnapCellsSize(sCols[c].dataType, hdr.numRows);
+        }
+        if (ofs != hdr.ofsStrOfs)
+            return false;
+        
+        // string offsets need to be ascending within the string data
+        for (uint32_t i = 0; i < hdr.numStrings; i++)
+            if (strOfs[i] > strOfs[i+1])
+                return false;
+        if (strOfs[hdr.numStrings] > strSize)
+            return false;
+        // string indexes need to be valid
+        auto validIdx = [&hdr](uint32_t idx) { return idx < hdr.numStrings; };
+        for (uint32_t c = 0; c < hdr.numCols; c++) {
+            if (!validIdx(sCols[c].nameIdx))
+                return false;
+            const uint32_t* pStr = reinterpret_cast<const uint32_t*>(file.data + cellOfs[c]);
+            for (uint32_t r = 0; r < hdr.numRows; r++)
+                if (pStr[r] != SNAP_NO_VALUE && !validIdx(pStr[r]))
+                    return false;
+        }
+        auto getStr = [strOfs,strData](uint32_t idx) -> std::string
+        { return std::string(strData + strOfs[idx], strOfs[idx+1] - strOfs[idx]); };
+        
+        // The file is valid, so now we replace everything
+        Clear();
+        cols.clear();
+        colOrder.clear();
+        for (uint32_t c = 0; c < hdr.numCols; c++) {
+            const SnapColTy& sc = sCols[c];
+            ListColumnDef def (getStr(sc.nameIdx), sc.width, DataTypeTy(sc.dataType),
+                               sc.bVisible != 0, CollationTy(sc.collation));
+            def.bAutoWidth = sc.bAutoWidth != 0;
+            def.aggregate = AggregateTy(sc.aggregate);
+            AddCol(c, std::move(def));
+        }
+        // take over the column order only if it is a permutation of all columns
+        std::vector<unsigned> order (sOrder, sOrder + hdr.numCols);
+        std::vector<unsigned> check (order);
+        std::sort(check.begin(), check.end());
+        bool bPerm = true;
+        for (uint32_t c = 0; c < hdr.numCols && bPerm; c++)
+            bPerm = check[c] == c;
+        if (bPerm)
+            colOrder = std::move(order);
+        
+        // rows are stored in display order, so there is no need to search for duplicates or to sort
+        rows.reserve(hdr.numRows);
+        for (uint32_t r = 0; r < hdr.numRows; r++) {
+            rows.emplace_back((void*)uintptr_t(sRows[r].refCon));
+            ListRow& row = rows.back();
+            // the row has values up to the last column storing one
+            uint32_t len = hdr.numCols;
+            while (len > 0 &&
+                   reinterpret_cast<const uint32_t*>(file.data + cellOfs[len-1])[r] == SNAP_NO_VALUE)
+                --len;
+            row.reserve(len);
+            for (uint32_t c = 0; c < len; c++) {
+                const uint32_t idx = reinterpret_cast<const uint32_t*>(file.data + cellOfs[c])[r];
+                row.emplace_back(idx == SNAP_NO_VALUE ? std::string() : getStr(idx));
+                ListItem& item = row.back();
+                const uint64_t valOfs = cellOfs[c] + SnapAlign(uint64_t(hdr.numRows) * sizeof(uint32_t));
+                if (sCols[c].dataType == DTY_INT || sCols[c].dataType == DTY_CHECKBOX)
+                    item.iVal = reinterpret_cast<const int32_t*>(file.data + valOfs)[r];
+                else if (sCols[c].dataType == DTY_DOUBLE)
+                    item.dVal = reinterpret_cast<const double*>(file.data + valOfs)[r];
+            }
+            row.sequNr = sRows[r].sequNr;
+            row.height = sRows[r].height;
+            sequRow = std::max(sequRow, row.sequNr);
+            row.slot = AllocSlot(row.refCon);
+            DoUpdateKeys(row);
+            DoIndexRow(row);
+        }
+        
+        // sorting state as saved, which is the order the rows are in already
+        sortedBy = hdr.sortedBy < hdr.numCols ? hdr.sortedBy : 0;
+        sorted = hdr.sorted >= SORT_UNSUPPORTED && hdr.sorted <= SORT_DESCENDING ? SortingTy(hdr.sorted) : SORT_UNSORTED;
+        bRowTopsDirty = true;
+        bTypeIdxDirty = true;
+        bColGeoDirty = true;
+        return true;
+    }
+    
+    
     // Crops texts of header and content to match geometry
+    /// Only the header texts are cropped here right away. For the values only
+    /// the column's `cropWidth` is defined, which DoDrawRow() applies to the
+    /// values of rows actually drawn.
     void ListBox::DoCropTexts ()
     {
-        // Width to calculate with
-        int width = Width();
-        // reserve space for scrollbar if needed
-        if (rows.size() > rowMax)
-            width -= gCHAR_AVG_WIDTH + 1;
-
+        // make sure we work on current column geometry
+        UpdateColGeometry();
         
-        // current column's starting position
-        size_t x = 0;
+        // Width to calculate with
+        const int width = GetColAreaWidth();
         
-        // loop over all columns
-        for (unsigned colId = 0;
-             colId < cols.size();
-             colId++)
+        // loop over the frozen columns and then the scrolling columns shown,
+        // until we are outside the list box
+        for (size_t i = FirstDrawCol(); i < colVis.size(); i = NextDrawCol(i))
         {
-            ListColumnDef& def = cols[colId];
+            // current column's starting position
+            const int x = GetColX(i);
+            if (x >= width)
+                break;
+            
             // visible width of the column
-            const size_t w =
-                !def.bVisible ? 0 :
-                int(x) >= width ? 0 :
-                std::min(size_t(width) - x, (size_t)def.width);
+            const unsigned colId = colVis[i];
+            ListColumnDef& def = cols[colId];
+            const size_t w = (size_t)std::max(std::min(width - x, def.width), 0);
             
             // set header text's cropped width
             def.name.SetWidth(w);
             
-            // also crop all data elements to that width
-            for (ListRow& row: rows)
-                row[colId].SetWidth(w);
-            
-            // increment starting pos of next column
-            x += w;
+            // data elements will be cropped to that width when drawn
+            def.cropWidth = w;
         }
     }
-
     
-    // Called by MainWnd, this function does the drawing of the list
-    void ListBox::DoDraw (const Rect& r)
+    // Rebuilds cached column geometry (visible columns and their offsets) if needed
+    void ListBox::UpdateColGeometry ()
     {
-        // draw the background
-        Widget::DoDraw(r);
-        
-        // get the correct foreground color
-        float txtColor[4];
-        TranslateColor(colFg, txtColor);
-
-        // represents the area of one row, starting with the header
-        Rect rowRect (r.Tl(),
-                      {r.Right(), r.Top()-int(lnHeight)});
-        // row doesn't fit into widget's area?
-        if (rowRect.Bottom() < r.Bottom())
+        if (!bColGeoDirty)
             return;
-
-        // Draw column headers first
-        DoDrawHeader(rowRect, GetGlobalColor(COL_COLUMN_HEADER));
-
-        // reserve space for scrollbar if needed
-        if (rows.size() > rowMax)
-            rowRect.SetRight(rowRect.Right() - gCHAR_AVG_WIDTH - 1);
         
-        // move on to next row
-        rowRect += Point(0,-int(lnHeight));
-        
-        // Draw each item of each row of the list
-        bool bAlternateRow = false;         // every other row gets lighter background
-        int rowsToSkip = (int)rowFirst;     // number of rows to skip due to scrolling
-        for (const ListRow& row: rows) {
-            // Skip those rows which are scrolled away at beginning
-            if (--rowsToSkip >= 0)
-                continue;
-            
-            // Don't draw beyond our widget space
-            if (rowRect.Bottom() < r.Bottom())
-                break;
-            
-            // if this is the selected row then draw a highlite background
-            if (selRefCon == row.refCon) {
-                SetColor(gCOL_STD[COL_SELECTION]);
-                DrawRect(rowRect);
-                // if we also have focus add a darker frame around the selection
-                if (HasFocus()) {
-                    SetColor(gCOL_STD[COL_FOCUS_BORDER]);
-                    DrawFrame(rowRect);
-                }
-            }
-            // for alternating row make background a bit lighter
-            else if (bAlternateRow) {
-                SetColor(COL_WHITE_LIGHTTRANS);
-                DrawRect(rowRect);
+        // collect visible columns in display order and sum up their widths
+        colVis.clear();
+        colRight.clear();
+        int right = 0;
+        for (unsigned colId: colOrder)
+        {
+            ListColumnDef& def = cols[colId];
+            if (def.bVisible) {
+                if (def.bAutoWidth)
+                    def.width = GetColAutoWidth(colId);
+                colVis.push_back(colId);
+                colRight.push_back(right += def.width);
             }
-            bAlternateRow = !bAlternateRow;
-            
-            // draw the content of the row
-            DoDrawRow(rowRect, row, txtColor);
-            
-            // move on to next row
-            rowRect += Point(0,-int(lnHeight));
+        }
+        
+        // make sure the horizontal scroll position remains valid
+        if (colFirst >= colVis.size())
+            colFirst = colVis.empty() ? 0 : colVis.size() - 1;
+        colFirst = std::max(colFirst, GetFrozenEnd());
+        bColGeoDirty = false;
+    }
+    
+    // Prefix sums of row heights, rebuilt if needed
+    const PrefixSumTree& ListBox::GetRowTops () const
+    {
+        if (bRowTopsDirty || rowTops.size() != rows.size()) {
+            std::vector<int> heights;
+            heights.reserve(rows.size());
+            for (const ListRow& row: rows)
+                heights.push_back(GetRowHeight(row));
+            rowTops.assign(heights);
+            bRowTopsDirty = false;
+        }
+        return rowTops;
+    }
+    
+    // Height of the scrollbar thumb, proportional to the visible part of all rows
+    int ListBox::GetThumbHeight () const
+    {
+        const int contentHeight = GetContentHeight();
+        const int viewHeight = GetViewHeight();
+        if (contentHeight <= viewHeight)
+            return viewHeight;
+        // but not too small to be grabbed
+        return std::max(int((long long)viewHeight * viewHeight / contentHeight),
+                        gCHAR_AVG_WIDTH);
+    }
+    
+    // Scroll to the position, limited to the valid range
+    bool ListBox::DoScrollTo (int _y)
+    {
+        const int yMax = GetMaxScrollPos();
+        scrollY = std::max(std::min(_y, yMax), 0);
+        rowFirst = unsigned(FindRowAt(scrollY));
+        return scrollY == _y;
+    }
+    
+    // Move the list as per the current scrolling velocity and let the velocity decay
+    /// Exponential decay: The distance left to travel is always `scrollVel * SCROLL_INERTIA_TAU`
+    void ListBox::DoScrollInertia ()
+    {
+        if (std::abs(scrollVel) <= 0.0f)
+            return;
+        
+        const std::chrono::steady_clock::time_point now = mainWnd.GetFrameContext().now;
+        const float dt = std::chrono::duration<float>(now - scrollLast).count();
+        scrollLast = now;
+        
+        // distance to travel during `dt`, and the reduced velocity thereafter
+        const float decay = std::exp(-dt / SCROLL_INERTIA_TAU);
+        const float dist = scrollVel * SCROLL_INERTIA_TAU * (1.0f - decay) + scrollRemain;
+        scrollVel *= decay;
+        
+        // only whole boxels are applied, the fraction is kept for next time
+        const int d = int(dist);
+        scrollRemain = dist - float(d);
+        
+        // stop when reaching either end or when less than half a boxel is left to go
+        if (!DoScrollTo(scrollY + d) ||
+            std::abs(scrollVel * SCROLL_INERTIA_TAU + scrollRemain) < 0.5f)
+            scrollVel = scrollRemain = 0.0f;
+    }
+    
+    // Width available for columns, which excludes the vertical scrollbar if shown
+    int ListBox::GetColAreaWidth () const
+    {
+        // reserve space for scrollbar if needed
+        if (HasVertScrollbar())
+            return Width() - gCHAR_AVG_WIDTH - 1;
+        return Width();
+    }
+
+    
+    // Width of the widest value or the header of a column, based on its width histogram
+    int ListBox::GetColAutoWidth (unsigned colId)
+    {
+        ListColumnDef& def = cols.at(colId);
+        
+        // First time we need the histogram we have to measure all values once,
+        // from then on it is maintained when adding/changing/removing values
+        if (!def.bWidthHist) {
+            def.widthHist.clear();
+            def.bWidthHist = true;
+            for (ListRow& row: rows)
+                if (colId < row.size())
+                    DoIndexItem(colId, row[colId]);
+        }
+        
+        // the header needs to fit, too, including the sorting indicator
+        const std::string hdr = def.name.full() + " ^";
+        int w = (int)std::lround(MeasureString(xplmFont_Proportional,
+                                                   hdr.c_str(), int(hdr.size())));
+        // the widest value is the last element in the histogram
+        if (!def.widthHist.empty())
+            w = std::max(w, def.widthHist.crbegin()->first);
+        // some space to the next column
+        return w + gCHAR_AVG_WIDTH;
+    }
+    
+    // Account for a value in its column's width histogram and aggregate statistics
+    void ListBox::DoIndexItem (unsigned colId, ListItem& item)
+    {
+        if (colId >= cols.size())
+            return;
+        ListColumnDef& def = cols[colId];
+        
+        // numeric columns, which need it, keep their values for aggregates
+        if (def.bAggStats)
+            def.AggAdd(GetNumValue(item, def.dataType));
+        
+        // only columns, which need it, maintain a histogram
+        // (checkboxes don't draw any text)
+        if (!def.bWidthHist || def.dataType == DTY_CHECKBOX)
+            return;
+        
+        const std::string& s = item.GetS();
+        item.measWidth = (int)std::lround(MeasureString(xplmFont_Proportional,
+                                                            s.c_str(), int(s.size())));
+        // a new widest value changes the column width
+        if (def.bAutoWidth &&
+            (def.widthHist.empty() || item.measWidth > def.widthHist.crbegin()->first))
+            bColGeoDirty = true;
+        ++def.widthHist[item.measWidth];
+    }
+    
+    // Remove a value from its column's width histogram and aggregate statistics
+    void ListBox::DoUnindexItem (unsigned colId, const ListItem& item)
+    {
+        if (colId >= cols.size())
+            return;
+        ListColumnDef& def = cols[colId];
+        
+        // remove one instance of the value, if it is known
+        // (it might not be if changed directly via a row reference,
+        //  then the statistics are wrong and need to be collected anew)
+        if (def.bAggStats && !def.AggRemove(GetNumValue(item, def.dataType)))
+            def.AggReset();
+        
+        if (!def.bWidthHist || item.measWidth < 0)
+            return;
+        
+        std::map<int,unsigned>::iterator iter = def.widthHist.find(item.measWidth);
+        if (iter == def.widthHist.end())
+            return;
+        if (--iter->second == 0) {
+            // removed the last of the widest values? Then the column shrinks
+            if (def.bAutoWidth && std::next(iter) == def.widthHist.end())
+                bColGeoDirty = true;
+            def.widthHist.erase(iter);
+        }
+    }
+    
+    // Account for all values of a row in the width histograms
+    void ListBox::DoIndexRow (ListRow& row)
+    {
+        for (unsigned colId = 0; colId < cols.size() && colId < row.size(); colId++) {
+            DoFormatItem(colId, row[colId]);
+            DoIndexItem(colId, row[colId]);
+        }
+        DoUpdateRowStyle(row);
+    }
+    
+    // Evaluate the column's formatting rules for a value
+    /// The first matching value rule and the first matching row rule apply
+    void ListBox::DoFormatItem (unsigned colId, ListItem& item)
+    {
+        item.style = item.rowStyle = 0;
+        if (colId >= cols.size())
+            return;
+        const ListColumnDef& def = cols[colId];
+        for (const ListFormatRule& rule: def.fmtRules) {
+            uint8_t& s = rule.bRow ? item.rowStyle : item.style;
+            if (!s && rule.Matches(item, def.dataType))
+                s = rule.style;
+        }
+    }
+    
+    // Determine the row's style from its values' row styles
+    /// The first column (by id) imposing a row style wins
+    void ListBox::DoUpdateRowStyle (ListRow& row)
+    {
+        row.style = 0;
+        for (const ListItem& item: row)
+            if (item.rowStyle) {
+                row.style = item.rowStyle;
+                break;
+            }
+    }
+    
+    // Remove all values of a row from the width histograms
+    void ListBox::DoUnindexRow (const ListRow& row)
+    {
+        for (unsigned colId = 0; colId < cols.size() && colId < row.size(); colId++)
+            DoUnindexItem(colId, row[colId]);
+    }
+
+    
+    // Called by MainWnd, this function does the drawing of the list
+    void ListBox::DoDraw (const Rect& r)
+    {
+        // draw the background
+        Widget::DoDraw(r);
+        
+        // still scrolling due to inertia?
+        DoScrollInertia();
+        
+        // column definitions changed? Then recalc geometry and crop texts
+        if (bColGeoDirty)
+            DoCropTexts();
+        
+        // Find the range of scrolling columns to draw: from the first shown column
+        // until the first column, which reaches the right edge (binary search),
+        // frozen columns take away from the space available
+        const std::vector<int>::const_iterator iterEnd =
+        std::lower_bound(colRight.cbegin() + std::ptrdiff_t(std::min(colFirst, colRight.size())),
+                         colRight.cend(),
+                         GetColLeft(colFirst) + GetColAreaWidth() - GetFrozenWidth());
+        colDrawEnd = std::min(size_t(iterEnd - colRight.cbegin()) + 1, colVis.size());
+        
+        // get the correct foreground color
+        float txtColor[4];
+        TranslateColor(colFg, txtColor);
+
+        // represents the area of one row, starting with the header
+        Rect rowRect (r.Tl(),
+                      {r.Right(), r.Top()-int(lnHeight)});
+        // row doesn't fit into widget's area?
+        if (rowRect.Bottom() < r.Bottom())
+            return;
+
+        // Draw column headers first
+        DoDrawHeader(rowRect, GetGlobalColor(COL_COLUMN_HEADER));
+
+        // reserve space for scrollbar if needed
+        if (HasVertScrollbar())
+            rowRect.SetRight(rowRect.Right() - gCHAR_AVG_WIDTH - 1);
+        
+        // Rows are drawn into the area below the header (and above the footer) only,
+        // which cuts rows scrolled partially out of view
+        const int viewBottom = r.Bottom() + (bFooter ? int(lnHeight) : 0);
+        const int rowsRight = rowRect.Right();
+        DrawPushClip(Rect(rowRect.Left(), rowRect.Bottom(), rowRect.Right(), viewBottom));
+        
+        // first row is partially scrolled up by the sub-row offset
+        int top = rowRect.Bottom() + (scrollY - GetRowTop(rowFirst));
+        
+        // Draw only the rows intersecting the view, starting directly with the first one shown
+        for (size_t i = rowFirst; i < rows.size() && top > viewBottom; i++) {
+            ListRow& row = rows[i];
+            rowRect = Rect(rowRect.Left(), top, rowRect.Right(), top - GetRowHeight(row));
+            
+            // if this is a selected row then draw a highlite background
+            if (IsSelected(row)) {
+                SetColor(gCOL_STD[COL_SELECTION]);
+                DrawRect(rowRect);
+                // if we also have focus add a darker frame around the current row
+                if (HasFocus() && selRefCon == row.refCon) {
+                    SetColor(gCOL_STD[COL_FOCUS_BORDER]);
+                    DrawFrame(rowRect);
+                }
+            }
+            // every other row gets a bit lighter background
+            else if (i % 2) {
+                SetColor(COL_WHITE_LIGHTTRANS);
+                DrawRect(rowRect);
+            }
+            
+            // draw the content of the row
+            DoDrawRow(rowRect, row, txtColor);
+            
+            // move on to next row
+            top = rowRect.Bottom();
+        }
+        DrawPopClip();
+        
+        // footer row at the bottom, if it fits below the header
+        if (bFooter && viewBottom <= r.Top() - int(lnHeight))
+            DoDrawFooter(Rect(r.Left(), viewBottom, rowsRight, r.Bottom()), txtColor);
+        
+        // divider between frozen and scrolling columns
+        if (colFrozen > 0 && colFirst < colVis.size()) {
+            const int x = r.Left() + GetFrozenWidth();
+            SetColor(gCOL_STD[COL_LINE]);
+            DrawLine({{x, r.Top()}, {x, r.Bottom()}});
         }
         
         // draw scrollbar if needed
-        if (rows.size() > rowMax)
+        if (HasVertScrollbar())
             DoDrawVertScrollbar(r);
+        
+        // draw the resize cursor if the mouse is on a column border,
+        // DoHandleCursor() will request it again for the next frame
+        bCursorDrawn = bCursorResize;
+        if (bCursorResize) {
+            // clipped to the list box, so that it needs not be drawn anew beyond it
+            DrawPushClip(r);
+            SetColor(gCOL_STD[COL_STD_FG]);
+            DrawResizeCursor(r.Tl() + cursorPos, RESIZE_CURSOR_SIZE);
+            DrawPopClip();
+            bCursorResize = false;
+        }
     }
 
     
@@ -1607,24 +3371,20 @@ namespace TFW {
     void ListBox::DoDrawHeader (const Rect& rowRect, const float txtColor[4])
     {
         std::string buf;
-        Rect cellRect(rowRect);
         DataTypeTy prevDataType = DTY_NULL;         // data type of previous column
-        unsigned colId = 0;
-        for (ListColumnDef& def: cols) {
-            // completely skip invisible columns
-            if (!def.bVisible) {
-                colId++;
-                continue;
-            }
+        // only loop the columns, which are in view: frozen ones first, then the scrolling ones
+        for (size_t i = FirstDrawCol(); i < colDrawEnd; i = NextDrawCol(i)) {
+            const unsigned colId = colVis[i];
+            ListColumnDef& def = cols[colId];
             
             // the cell of this column header
-            cellRect.SetRight(cellRect.Left() + def.width);
+            const int left = rowRect.Left() + GetColX(i);
             // don't draw beyond limits
-            if (cellRect.Left() >= rowRect.Right())
+            if (left >= rowRect.Right())
                 break;
             // clip rectangle if not enough space for entire column
-            if (cellRect.Right() > rowRect.Right())
-                cellRect.SetRight(rowRect.Right());
+            Rect cellRect (left, rowRect.Top(),
+                           std::min(left + def.width, rowRect.Right()), rowRect.Bottom());
             
             // if a left-aligned column directly follows a right-aligned column we need some space inbetween
             if (def.dataType == DTY_STRING && prevDataType >= DTY_INT)
@@ -1653,342 +3413,1339 @@ namespace TFW {
                 def.name = std::move(buf);
             }
             
-            // if a left-aligned column directly follows a right-aligned column we need some space inbetween
-            if (def.dataType == DTY_STRING && prevDataType >= DTY_INT)
-                cellRect.SetLeft(cellRect.Left() - gCHAR_AVG_WIDTH);
-
-            // move cell rect's left border to next column, thereby removing the 1 point move for "bold" drawing
-            cellRect += Point(def.width-1);
             prevDataType = def.dataType;
-            colId++;
         }
 
         // Draw line under header text as divider
         SetColor(gCOL_STD[COL_LINE]);
         DrawLine({rowRect.Bl(), rowRect.Br()});
+        
+        // While moving a column mark the position it would be dropped at
+        if (colDrag == COLDRAG_MOVE) {
+            const int x = rowRect.Left() + GetColX(colDropIdx);
+            TextQueueFlush();                   // the marker goes on top of the header texts
+            SetColor(gCOL_STD[COL_FOCUS_BORDER]);
+            DrawLine({{x, rowRect.Top()}, {x, rowRect.Bottom()}});
+        }
+    }
+    
+    // Draw the footer row with the columns' aggregates
+    /// The aggregates are maintained incrementally, so getting them is cheap,
+    /// only formatting and measuring happen per frame, and only for the columns in view.
+    void ListBox::DoDrawFooter (const Rect& rowRect, const float txtColor[4])
+    {
+        // Draw line above footer as divider
+        SetColor(gCOL_STD[COL_LINE]);
+        DrawLine({rowRect.Tl(), rowRect.Tr()});
+        
+        // one clip area for the whole row, values too wide for their cell are cropped instead
+        DrawPushClip(rowRect);
+        
+        // only loop the columns, which are in view: frozen ones first, then the scrolling ones
+        for (size_t i = FirstDrawCol(); i < colDrawEnd; i = NextDrawCol(i)) {
+            const unsigned colId = colVis[i];
+            const ListColumnDef& def = cols[colId];
+            double val = 0.0;
+            if (def.aggregate == AGG_NONE || !GetColAggregate(colId, def.aggregate, val))
+                continue;
+            
+            // the cell of this column's aggregate
+            const int left = rowRect.Left() + GetColX(i);
+            if (left >= rowRect.Right())
+                break;
+            const Rect cell (left, rowRect.Top(),
+                             std::min(left + def.width, rowRect.Right()), rowRect.Bottom());
+            
+            // counts and aggregates of integers (but their mean) have no decimals
+            const int prec = def.aggregate == AGG_MEAN ? 2 :
+                             def.aggregate == AGG_COUNT || def.dataType == DTY_INT ? 0 : 2;
+            int len = snprintf(lbBuf, sizeof(lbBuf), "%.*f", prec, val);
+            len = std::clamp(len, 0, int(sizeof(lbBuf)) - 1);
+            while (len > 0 && MeasureString(xplmFont_Proportional, lbBuf, len) > float(cell.Width()))
+                lbBuf[--len] = '\0';
+            DrawAlignedString(const_cast<float*>(txtColor), cell, TXA_RIGHT,
+                              lbBuf, xplmFont_Proportional);
+        }
+        DrawPopClip();
     }
 
     
     // Draw the text items of a row
-    void ListBox::DoDrawRow (const Rect& rowRect, const ListRow& row, const float txtColor[4])
+    void ListBox::DoDrawRow (const Rect& rowRect, ListRow& row, const float txtColor[4])
     {
-        // size of a cell (space per item in a column)
-        Rect cell = rowRect;
         DataTypeTy prevDataType = DTY_NULL;         // data type of previous column
-
-        // loop over all columns
-        for (unsigned colId = 0;
-             colId < cols.size();
-             colId++)
+        // only loop the columns, which are in view: frozen ones first, then the scrolling ones
+        for (size_t i = FirstDrawCol(); i < colDrawEnd; i = NextDrawCol(i))
         {
+            const unsigned colId = colVis[i];
             const ListColumnDef& def = cols[colId];
-            if (def.bVisible) {
-                // set cell's width to match column width
-                cell.SetTr({cell.Left() + def.width, cell.Top()});
-                
-                // don't draw beyond limits
-                if (cell.Left() >= rowRect.Right())
-                    break;
-                // clip rectangle if not enough space for entire column
-                if (cell.Right() > rowRect.Right())
-                    cell.SetRight(rowRect.Right());
+            // size of a cell (space per item in a column)
+            const int left = rowRect.Left() + GetColX(i);
+            // don't draw beyond limits
+            if (left >= rowRect.Right())
+                break;
+            // clip rectangle if not enough space for entire column
+            Rect cell (left, rowRect.Top(),
+                       std::min(left + def.width, rowRect.Right()), rowRect.Bottom());
 
-                // if a left-aligned column directly follows a right-aligned column we need some space inbetween
-                if (def.dataType == DTY_STRING && prevDataType >= DTY_INT)
-                    cell.SetLeft(cell.Left() + gCHAR_AVG_WIDTH);
-                
-                // draw row item's text
-                if (colId < row.size()) {
-                    // Text color overriden in ListItem?
-                    const ListItem& item = row[colId];
-                    const float* pCol = std::isnan(item.col[0]) ? txtColor : item.col;
-                    if (def.dataType != DTY_CHECKBOX) {
-                        DrawAlignedString(const_cast<float*>(pCol), cell,
-                                          def.dataType >= DTY_INT ? TXA_RIGHT : TXA_LEFT,
+            // if a left-aligned column directly follows a right-aligned column we need some space inbetween
+            if (def.dataType == DTY_STRING && prevDataType >= DTY_INT)
+                cell.SetLeft(cell.Left() + gCHAR_AVG_WIDTH);
+            
+            // the left-most column might be indented
+            const int indent = i == 0 ? std::min(GetRowIndent(row), cell.Width()) : 0;
+            cell.SetLeft(cell.Left() + indent);
+            
+            // draw row item's text
+            if (colId < row.size()) {
+                // Text color overriden in ListItem? Otherwise by the value's or the row's style
+                ListItem& item = row[colId];
+                const ListStyleTy& style = styles[item.style ? item.style : row.style];
+                const float* pCol = !std::isnan(item.col[0])  ? item.col :
+                                    !std::isnan(style.col[0]) ? style.col : txtColor;
+                if (def.dataType != DTY_CHECKBOX) {
+                    // crop the value if column width changed since last drawing
+                    item.SetWidth(def.cropWidth > size_t(indent) ? def.cropWidth - size_t(indent) : 0);
+                    const TextAlignTy align = def.dataType >= DTY_INT ? TXA_RIGHT : TXA_LEFT;
+                    DrawAlignedString(const_cast<float*>(pCol), cell, align,
+                                      item.GetCroppedS(), xplmFont_Proportional);
+                    // Bold text? Requires one more write operation with ofset 1 pt
+                    if (style.bBold)
+                        DrawAlignedString(const_cast<float*>(pCol), cell + Point(1,0), align,
                                           item.GetCroppedS(), xplmFont_Proportional);
-                    } else {
-                        // Checkbox type is somewhat special
-                        Rect cb = MakeCheckboxSquare(cell);
-                        cb.Expand(-3);
-                        // Center the checkbox in the item cell
-                        cb += Point((cell.Width() - cb.Width())/2, 0);
-                        // Draw in proper color, potentially "disabled" color
-                        DrawSetColor(item.IsEnabled() ? pCol : GetGlobalColor(COL_STD_FG_DISABLED));
-                        DrawCheckBox(cb, item.IsSet(), false);
-                    }
+                } else {
+                    // Checkbox type is somewhat special
+                    Rect cb = MakeCheckboxSquare(cell);
+                    cb.Expand(-3);
+                    // Center the checkbox in the item cell
+                    cb += Point((cell.Width() - cb.Width())/2, 0);
+                    // Draw in proper color, potentially "disabled" color
+                    DrawSetColor(item.IsEnabled() ? pCol : GetGlobalColor(COL_STD_FG_DISABLED));
+                    DrawCheckBox(cb, item.IsSet(), false);
                 }
+            }
 
-                // if a left-aligned column directly follows a right-aligned column we need some space inbetween
-                if (def.dataType == DTY_STRING && prevDataType >= DTY_INT)
-                    cell.SetLeft(cell.Left() - gCHAR_AVG_WIDTH);
-                
-                // move cell rect to next column's beginning
-                cell += Point(def.width,0);
-                prevDataType = def.dataType;
+            prevDataType = def.dataType;
+        }
+    }
+    
+    
+    // Draw a list box's vertical scrollbar
+    void ListBox::DoDrawVertScrollbar (const Rect& _r)
+    {
+        // Scrollbar is on right hand side, one character spacing thick,
+        // between header and footer
+        Rect sbRect(_r);
+        sbRect.Left() = sbRect.Right() - gCHAR_AVG_WIDTH;
+        sbRect.Top() -= int(lnHeight);
+        if (bFooter)
+            sbRect.SetBottom(sbRect.Bottom() + int(lnHeight));
+        
+        // background
+        SetColor(gCOL_STD[COL_SCROLLBAR_BG]);
+        DrawRect(sbRect);
+        
+        // thumb, size depends on visible portion of list items,
+        // position maps the scroll position linearly to the free track
+        const int thumbHeight = GetThumbHeight();
+        const int track = sbRect.Height() - thumbHeight;
+        const int yMax = GetMaxScrollPos();
+        const int top = _r.Top();
+        sbThumbTop      = - int(lnHeight) - (yMax > 0 ? int((long long)track * scrollY / yMax) : 0);
+        sbThumbBottom   = sbThumbTop - thumbHeight;
+        sbRect.Top()   = top + sbThumbTop;
+        sbRect.SetBottom(top + sbThumbBottom);
+        
+        // reduce size of all edges by 1 to leave a tiny frame around
+        // where the background stays visible
+        sbRect.Expand(-1);
+        
+        SetColor(gCOL_STD[COL_SCROLLBAR_FG]);
+        DrawRect(sbRect);
+    }
+    
+
+    // Re-sort the existing list of rows according to sorting criteria
+    void ListBox::DoSort ()
+    {
+        // sanity check that column-to-sort-by exists
+        if (sortedBy >= cols.size()) return;
+        const DataTypeTy _dataType = cols[sortedBy].dataType;
+        
+        // String values need collation keys for comparison,
+        // which are only computed if missing (like after direct changes to a value)
+        if (_dataType == DTY_STRING && cols[sortedBy].collation != COLL_BINARY)
+            for (ListRow& row: rows)
+                if (sortedBy < row.size())
+                    row[sortedBy].UpdateKey(cols[sortedBy].collation);
+
+        // re-sort the list of rows
+        DoSortRows();
+        bTypeIdxDirty = true;
+        bRowTopsDirty = true;
+        
+        // Make selected row still visible
+        MakeSelVisible();
+    }
+    
+    // Order all rows as per RowLess()
+    void ListBox::DoSortRows ()
+    {
+        std::sort(rows.begin(), rows.end(),
+                  [this](const ListRow& r1, const ListRow& r2)->bool
+                  { return RowLess(r1, r2); });
+    }
+    
+    // Compute the collation keys of a row's string values
+    void ListBox::DoUpdateKeys (ListRow& row)
+    {
+        for (unsigned colId = 0; colId < cols.size() && colId < row.size(); colId++)
+            if (cols[colId].dataType == DTY_STRING)
+                row[colId].UpdateKey(cols[colId].collation);
+    }
+    
+    // Parse the lines of a delimited text into values
+    /// Only reads list box members, so that it can run in parallel threads
+    void ListBox::DoParseDelimited (const char* _begin, const char* _end, char _delim,
+                                    const std::vector<unsigned>& _colIds,
+                                    std::vector<ImportRowTy>& _out) const
+    {
+        // collation keys of string values seen so far, per column
+        std::vector<std::unordered_map<std::string,std::string>> keyPool (cols.size());
+        std::string quoted;
+        std::string_view field;
+        
+        for (const char* p = _begin; p < _end; ) {
+            // one line, without line break
+            const char* eol = (const char*)memchr(p, '\n', size_t(_end - p));
+            if (!eol) eol = _end;
+            const char* const next = eol < _end ? eol + 1 : _end;
+            if (eol > p && eol[-1] == '\r')
+                --eol;
+            if (eol == p) {                     // skip empty lines
+                p = next;
+                continue;
+            }
+            
+            _out.emplace_back(cols.size());
+            ImportRowTy& row = _out.back();
+            for (size_t f = 0; ; f++) {
+                p = NextField(p, eol, _delim, quoted, field);
+                const unsigned colId = f < _colIds.size() ? _colIds[f] : UINT_MAX;
+                if (colId < cols.size()) {
+                    const ListColumnDef& def = cols[colId];
+                    ImportValTy& val = row[colId];
+                    switch (def.dataType) {
+                        case DTY_INT: {
+                            const std::string_view s = TrimField(field);
+                            val.bNum = std::from_chars(s.data() + (!s.empty() && s.front() == '+'),
+                                                       s.data() + s.size(), val.i).ec == std::errc();
+                            if (!val.bNum)
+                                val.s = field;
+                            break;
+                        }
+                        case DTY_DOUBLE:
+                            val.s = TrimField(field);
+                            val.bNum = ParseDouble(val.s, val.d);
+                            break;
+                        case DTY_CHECKBOX:
+                            val.i = !IsFalseField(TrimField(field));
+                            break;
+                        default:
+                            val.s = field;
+                            // collation key computed once per distinct value
+                            if (def.collation != COLL_BINARY) {
+                                std::unordered_map<std::string,std::string>& pool = keyPool[colId];
+                                std::unordered_map<std::string,std::string>::iterator iter = pool.find(val.s);
+                                if (iter == pool.end())
+                                    iter = pool.emplace(val.s, MakeCollationKey(val.s, def.collation)).first;
+                                val.key = iter->second;
+                            }
+                    }
+                }
+                if (p >= eol) break;
+            }
+            p = next;
+        }
+    }
+    
+    // Keep a row, which is no longer needed, for reuse by ObtainRow()
+    void ListBox::RetireRow (ListRow&& row)
+    {
+        // rows without any storage are not worth keeping
+        if (row.capacity() > 0 && rowPool.size() < rowPoolMax)
+            rowPool.emplace_back(std::move(row));
+    }
+    
+    // Limit the number of retired rows kept for reuse
+    void ListBox::SetRowPoolLimit (size_t _max)
+    {
+        rowPoolMax = _max;
+        if (rowPool.size() > rowPoolMax)
+            rowPool.erase(rowPool.begin() + ptrdiff_t(rowPoolMax), rowPool.end());
+    }
+    
+    // Report the memory held by rows and values
+    ListMemStatsTy ListBox::GetMemStats () const
+    {
+        ListMemStatsTy stats;
+        stats.numRows = rows.size();
+        stats.numPooledRows = rowPool.size();
+        // the row vectors themselves
+        for (const ListRowVecTy* v: { &rows, &rowPool }) {
+            if (v->capacity()) {
+                stats.numHeapBlocks++;
+                stats.bytesReserved += v->capacity() * sizeof(ListRow);
+            }
+        }
+        stats.bytesUsed += rows.size() * sizeof(ListRow);
+        // the rows' values
+        for (const ListRow& row: rows)
+            stats.Add(row, true);
+        for (const ListRow& row: rowPool)
+            stats.Add(row, false);
+        return stats;
+    }
+    
+    // Make a row, which is new to the list, known
+    void ListBox::DoAdoptRow (ListRow& row)
+    {
+        // the always increasing sequence number defines the "unsorted" order
+        row.SetSequNr(++sequRow);
+        // and a slot for selection
+        row.slot = AllocSlot(row.refCon);
+    }
+    
+    
+    // define the new selected row and inform the main window
+    void ListBox::DoSelectRow (ListRow& _selRow)
+    {
+        // were other rows selected, too?
+        const bool bOthers = selCount > (IsSelected(_selRow) ? 1 : 0);
+        ClearSelBits();
+        SetSelBit(_selRow.slot, true);
+        selRefCon = selAnchor = _selRow.refCon;
+        mainWnd.MsgListSelChanged(*this, _selRow);
+        if (bMultiSel) {
+            const size_t pos = size_t(&_selRow - rows.data());
+            if (bOthers)
+                mainWnd.MsgListSelRangeChanged(*this, 0, rows.size()-1);
+            else
+                mainWnd.MsgListSelRangeChanged(*this, pos, pos);
+        }
+    }
+    
+    // toggle a row's selection, making it the current row, and inform the main window
+    void ListBox::DoToggleRow (ListRow& _row)
+    {
+        SetSelBit(_row.slot, !IsSelected(_row));
+        selRefCon = selAnchor = _row.refCon;
+        mainWnd.MsgListSelChanged(*this, _row);
+        const size_t pos = size_t(&_row - rows.data());
+        mainWnd.MsgListSelRangeChanged(*this, pos, pos);
+    }
+    
+    // select the rows between the two display positions, and inform the main window
+    void ListBox::DoSelectRange (size_t _from, size_t _to)
+    {
+        if (_from >= rows.size() || _to >= rows.size())
+            return;
+        const size_t first = std::min(_from, _to);
+        const size_t last  = std::max(_from, _to);
+        
+        // were rows outside the range selected?
+        const bool bOthers = selCount > 0;
+        ClearSelBits();
+        for (size_t i = first; i <= last; i++)
+            SetSelBit(rows[i].slot, true);
+        
+        // the range's end becomes the current row, the anchor stays
+        selRefCon = rows[_to].refCon;
+        selAnchor = rows[_from].refCon;
+        mainWnd.MsgListSelChanged(*this, rows[_to]);
+        if (bOthers)
+            mainWnd.MsgListSelRangeChanged(*this, 0, rows.size()-1);
+        else
+            mainWnd.MsgListSelRangeChanged(*this, first, last);
+    }
+    
+    // Assign a slot to a new row
+    unsigned ListBox::AllocSlot (void* _refCon)
+    {
+        unsigned slot = 0;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            slotRefCon[slot] = _refCon;
+        } else {
+            slot = unsigned(slotRefCon.size());
+            slotRefCon.push_back(_refCon);
+        }
+        return slot;
+    }
+    
+    // Return a removed row's slot for reuse
+    void ListBox::FreeSlot (unsigned _slot)
+    {
+        SetSelBit(_slot, false);
+        slotRefCon[_slot] = nullptr;
+        freeSlots.push_back(_slot);
+    }
+    
+    // Select/deselect a slot in the bitset
+    void ListBox::SetSelBit (unsigned _slot, bool _b)
+    {
+        const size_t w = _slot / 64;
+        const uint64_t mask = uint64_t(1) << (_slot % 64);
+        if (w >= selBits.size()) {
+            if (!_b) return;
+            selBits.resize(w+1, 0);
+        }
+        if (bool(selBits[w] & mask) == _b)
+            return;
+        if (_b) {
+            selBits[w] |= mask;
+            ++selCount;
+        } else {
+            selBits[w] &= ~mask;
+            --selCount;
+        }
+    }
+    
+    // Deselect all slots
+    void ListBox::ClearSelBits ()
+    {
+        std::fill(selBits.begin(), selBits.end(), 0);
+        selCount = 0;
+    }
+
+    
+    // Find vector index by refCon
+    bool ListBox::FindRowIdx (void* _refCon,
+                              ListRowVecTy::const_iterator& iter) const
+    {
+        // search the vector by refCon
+        iter = std::find_if (rows.cbegin(), rows.cend(),
+                             [_refCon](const ListRow& r)
+                             { return r.refCon == _refCon; });
+        // found something?
+        return iter != rows.cend();
+    }
+    
+    // Find vector index by refCon
+    bool ListBox::FindRowIdx (void* _refCon,
+                              ListRowVecTy::iterator& iter)
+    {
+        // search the vector by refCon
+        iter = std::find_if (rows.begin(), rows.end(),
+                             [_refCon](const ListRow& r)
+                             { return r.refCon == _refCon; });
+        // found something?
+        return iter != rows.end();
+    }
+    
+    
+    // Find row by y coordinate, relative to top of list box
+    bool ListBox::FindRowIdx (int _y, ListRowVecTy::iterator& iter)
+    {
+        // _y needs to be negative: it's relative from top, and downward is negative,
+        // and it must be below the header row
+        if (_y > -int(lnHeight)) { iter = rows.end(); return false; }
+        
+        // the footer, if any, is not part of the rows' area
+        if (-_y - int(lnHeight) >= GetViewHeight()) { iter = rows.end(); return false; }
+        
+        // which row did we hit? Remove the header from calculation,
+        // but add the part of the list hidden due to scrolling
+        const size_t rowHit = FindRowAt(-_y - int(lnHeight) + scrollY);
+        
+        // If this now is in range of number of rows we have, then we found it
+        if (rowHit < rows.size()) {
+            iter = rows.begin() + std::ptrdiff_t(rowHit);
+            return true;
+        }
+
+        // clicked after all rows
+        iter = rows.end();
+        return false;
+    }
+
+
+    // Find column by x coordinate, relative to left of list box
+    unsigned ListBox::FindColIdx (int _x)
+    {
+        // make sure column geometry is up-to-date
+        if (bColGeoDirty)
+            DoCropTexts();
+        if (colVis.empty())             // sanity check
+            return 0;
+        
+        // the first column whose right border is right of x is the one,
+        // among the frozen or the scrolling columns
+        const bool bFrozen = _x < GetFrozenWidth();
+        std::vector<int>::const_iterator iter =
+        std::lower_bound(colRight.cbegin() + std::ptrdiff_t(bFrozen ? 0 : std::min(colFirst, colRight.size())),
+                         colRight.cend(),
+                         bFrozen ? _x : _x - GetFrozenWidth() + GetColLeft(colFirst));
+        // default: return last visible column
+        if (iter == colRight.cend())
+            --iter;
+        return colVis[size_t(iter - colRight.cbegin())];
+    }
+    
+    
+    // Find a column's right border close to x coordinate
+    bool ListBox::FindColBorder (int _x, size_t& _visIdx)
+    {
+        // make sure column geometry is up-to-date
+        if (bColGeoDirty)
+            DoCropTexts();
+        
+        // frozen columns' borders first
+        const size_t frozenEnd = GetFrozenEnd();
+        if (frozenEnd > 0 && _x - COL_GRAB_DIST <= GetFrozenWidth()) {
+            std::vector<int>::const_iterator iter =
+            std::lower_bound(colRight.cbegin(), colRight.cbegin() + std::ptrdiff_t(frozenEnd),
+                             _x - COL_GRAB_DIST);
+            if (iter != colRight.cbegin() + std::ptrdiff_t(frozenEnd) && *iter <= _x + COL_GRAB_DIST) {
+                _visIdx = size_t(iter - colRight.cbegin());
+                return true;
+            }
+        }
+        
+        // the first right border at or right of the grab area's left end
+        const int x = _x - GetFrozenWidth() + GetColLeft(colFirst);
+        std::vector<int>::const_iterator iter =
+        std::lower_bound(colRight.cbegin() + std::ptrdiff_t(std::min(colFirst, colRight.size())),
+                         colRight.cend(), x - COL_GRAB_DIST);
+        if (iter == colRight.cend() || *iter > x + COL_GRAB_DIST)
+            return false;
+        _visIdx = size_t(iter - colRight.cbegin());
+        return true;
+    }
+    
+    
+    // Find the index into `colVis`, before which a column moved to x would be inserted
+    size_t ListBox::FindColDropIdx (int _x)
+    {
+        // the column x is in, among the frozen or the scrolling columns
+        const bool bFrozen = _x < GetFrozenWidth();
+        const int x = bFrozen ? _x : _x - GetFrozenWidth() + GetColLeft(colFirst);
+        const size_t visIdx = size_t(std::lower_bound(colRight.cbegin() + std::ptrdiff_t(bFrozen ? 0 : std::min(colFirst, colRight.size())),
+                                                      colRight.cend(), x) -
+                                     colRight.cbegin());
+        if (visIdx >= colVis.size())
+            return colVis.size();
+        // left or right half of that column?
+        return x < (GetColLeft(visIdx) + colRight[visIdx]) / 2 ? visIdx : visIdx + 1;
+    }
+    
+    // Column searched by type-ahead
+    bool ListBox::GetTypeAheadCol (unsigned& colId)
+    {
+        // the sorting column if it holds strings
+        if (sorted > SORT_UNSORTED && sortedBy < cols.size() &&
+            cols[sortedBy].dataType == DTY_STRING)
+        {
+            colId = sortedBy;
+            return true;
+        }
+        
+        // otherwise the first visible string column
+        UpdateColGeometry();
+        for (unsigned id: colVis)
+            if (cols[id].dataType == DTY_STRING) {
+                colId = id;
+                return true;
+            }
+        return false;
+    }
+    
+    
+    // Find the first row, whose value in column `colId` starts with `_prefix`, ignoring case
+    ListRowVecTy::iterator ListBox::FindRowByPrefix (unsigned colId, const std::string& _prefix)
+    {
+        if (colId >= cols.size())
+            return rows.end();
+        const ListColumnDef& def = cols[colId];
+        const std::string kp = MakeCollationKey(_prefix, COLL_NOCASE);
+        
+        // Binary search works if the sort order keeps all values starting
+        // with the prefix together, which case-folding collations do.
+        // (Natural sorting only as long as the prefix contains no digits.)
+        if (sorted > SORT_UNSORTED && sortedBy == colId &&
+            (def.collation == COLL_NOCASE ||
+             (def.collation == COLL_NATURAL &&
+              std::none_of(_prefix.cbegin(), _prefix.cend(),
+                           [](char c){ return std::isdigit((unsigned char)c) != 0; }))))
+        {
+            // the row's collation key, in case of a digit-free prefix
+            // comparable with the case-folded prefix
+            auto key = [colId,&def](ListRow& row) -> const std::string&
+            {
+                row[colId].UpdateKey(def.collation);
+                return row[colId].GetKey();
+            };
+            
+            // rows not having a value in that column always come first
+            ListRowVecTy::iterator iter =
+            std::partition_point(rows.begin(), rows.end(),
+                                 [colId](const ListRow& row){ return colId >= row.size(); });
+            
+            if (sorted == SORT_ASCENDING)
+                // the first row not less than the prefix
+                iter = std::lower_bound(iter, rows.end(), kp,
+                                        [&key](ListRow& row, const std::string& k)
+                                        { return key(row) < k; });
+            else
+                // the first row not greater than all values starting with the prefix
+                iter = std::partition_point(iter, rows.end(),
+                                            [&key,&kp](ListRow& row)
+                                            {
+                                                const std::string& k = key(row);
+                                                return k > kp && k.compare(0, kp.size(), kp) != 0;
+                                            });
+            
+            // does that row actually start with the prefix?
+            if (iter != rows.end() && key(*iter).compare(0, kp.size(), kp) == 0)
+                return iter;
+            return rows.end();
+        }
+        
+        // Otherwise we search an index of case-folded values, (re)built if needed
+        if (bTypeIdxDirty || typeIdxCol != colId) {
+            typeIdx.clear();
+            typeIdx.reserve(rows.size());
+            for (size_t i = 0; i < rows.size(); i++)
+                if (colId < rows[i].size())
+                    typeIdx.emplace_back(MakeCollationKey(rows[i][colId].GetS(), COLL_NOCASE), i);
+            std::sort(typeIdx.begin(), typeIdx.end());
+            typeIdxCol = colId;
+            bTypeIdxDirty = false;
+        }
+        
+        // All values starting with the prefix are one range in the index,
+        // from that range we want the row shown first
+        size_t rowIdx = rows.size();
+        for (std::vector<std::pair<std::string,size_t>>::const_iterator iter =
+             std::lower_bound(typeIdx.cbegin(), typeIdx.cend(), std::make_pair(kp, size_t(0)));
+             iter != typeIdx.cend() && iter->first.compare(0, kp.size(), kp) == 0;
+             ++iter)
+            rowIdx = std::min(rowIdx, iter->second);
+        return rows.begin() + std::ptrdiff_t(rowIdx);
+    }
+    
+    
+    // Ensure that the selected row, if any, is scrolled into visibility
+    void ListBox::MakeSelVisible ()
+    {
+        if (selRefCon) {
+            ListRowVecTy::const_iterator iter;
+            if (FindRowIdx(selRefCon, iter)) {
+                const int rowTop = GetRowTop(size_t(std::distance(rows.cbegin(), iter)));
+                const int rowBottom = rowTop + GetRowHeight(*iter);
+                if (rowTop < scrollY)           // selected before first visible row
+                    SetScrollPos(rowTop);
+                else if (rowBottom > scrollY + GetViewHeight()) // selected past last visible row
+                    SetScrollPos(rowBottom - GetViewHeight());
+            }
+        }
+    }
+    
+    
+    // Change selected row upon mouse click
+    void ListBox::DoMouseClick (Point p, MouseBtnTy mouseBtn, XPLMMouseStatus inMouse)
+    {
+        // we only handle the left button
+        if (mouseBtn != MOUSE_LEFT)
+            return;
+        
+        // clicked into the header, or an operation started there?
+        if (colDrag != COLDRAG_NONE ||
+            (inMouse == xplm_MouseDown && p.y() >= -int(lnHeight)))
+        {
+            DoMouseClickHeader(p, inMouse);
+            return;
+        }
+        
+        // dragging the scrollbar's thumb maps the thumb's top directly to a scroll position
+        if (bThumbDrag) {
+            const int track = GetViewHeight() - GetThumbHeight();
+            const int thumbOfs = -int(lnHeight) - (p.y() + thumbDragOfs);
+            if (track > 0)
+                SetScrollPos(int((long long)thumbOfs * GetMaxScrollPos() / track));
+            if (inMouse == xplm_MouseUp)
+                bThumbDrag = false;
+            return;
+        }
+        
+        // everything else is handled upon mouse-down only
+        if (inMouse != xplm_MouseDown)
+            return;
+        
+        // Into which column was the click?
+        unsigned col = FindColIdx(p.x());
+        
+        // clicks into the footer have no effect
+        if (-p.y() - int(lnHeight) >= GetViewHeight())
+            return;
+        
+        // if there is a scrollbar then we need to check scrollbar clicks, too
+        if (HasVertScrollbar() && p.x() >= Width() - gCHAR_AVG_WIDTH)
+        {
+            if (p.y() >= sbThumbTop)            // scroll one page up
+                DoMouseWheel(p, 0, rowMax > 1 ? -int(rowMax)+1 : -1);
+            else if (p.y() <= sbThumbBottom)    // scroll one page down
+                DoMouseWheel(p, 0, rowMax > 1 ? int(rowMax)-1  :  1);
+            else {                              // start dragging the thumb
+                bThumbDrag = true;
+                thumbDragOfs = sbThumbTop - p.y();
+                scrollVel = scrollRemain = 0.0f;
+            }
+            return;
+        }
+        
+        // find the affected row of the list box
+        ListRowVecTy::iterator iter;
+        if (FindRowIdx(p.y(), iter)) {
+            // if we hit a Checkbox column in that row
+            if (col < cols.size() && cols.at(col).dataType == DTY_CHECKBOX &&
+                col < iter->size())
+            {
+                // toggle the "checked" status if that item is enabled
+                ListItem& li = iter->at(col);
+                if (li.IsEnabled())
+                    li.Set(!li.IsSet());
+            }
+            // Select the row, in multi-selection lists modifiers
+            // toggle the row or select a range from the anchor
+            const XPLMKeyFlags mods = bMultiSel ? GetModifierKeys() : 0;
+            ListRowVecTy::iterator iterAnchor;
+            if (mods & xplm_ControlFlag)
+                DoToggleRow(*iter);
+            else if ((mods & xplm_ShiftFlag) && FindRowIdx(selAnchor, iterAnchor))
+                DoSelectRange(size_t(iterAnchor - rows.begin()), size_t(iter - rows.begin()));
+            else
+                DoSelectRow(*iter);
+        }
+    }
+    
+    
+    // Handle mouse in the column header: sort, resize, and move columns
+    void ListBox::DoMouseClickHeader (Point p, XPLMMouseStatus inMouse)
+    {
+        switch (inMouse) {
+            case xplm_MouseDown:
+            {
+                // on a column border we start resizing, otherwise it is a click on a column
+                size_t visIdx = 0;
+                if (FindColBorder(p.x(), visIdx)) {
+                    colDrag = COLDRAG_RESIZE;
+                    colDragId = colVis[visIdx];
+                    colDragWidth = cols[colDragId].width;
+                } else {
+                    colDrag = COLDRAG_CLICK;
+                    colDragId = FindColIdx(p.x());
+                }
+                colDragX = p.x();
+                break;
+            }
+                
+            case xplm_MouseDrag:
+                // resizing changes the width of the one column only
+                if (colDrag == COLDRAG_RESIZE)
+                    SetColWidth(colDragId, std::max(colDragWidth + p.x() - colDragX,
+                                                    gCHAR_AVG_WIDTH));
+                // a click on a header, which got dragged for a bit, becomes a move
+                else if (colDrag == COLDRAG_MOVE ||
+                         std::abs(p.x() - colDragX) >= gCHAR_AVG_WIDTH)
+                {
+                    colDrag = COLDRAG_MOVE;
+                    colDropIdx = FindColDropIdx(p.x());
+                }
+                break;
+                
+            case xplm_MouseUp:
+                if (colDrag == COLDRAG_MOVE)
+                    MoveCol(colDragId, FindColDropIdx(p.x()));
+                // a click (without moving) sorts by the column we hit
+                else if (colDrag == COLDRAG_CLICK && sorted != SORT_UNSUPPORTED) {
+                    SortingTy direction = SORT_ASCENDING;
+                    if (colDragId == sortedBy) {    // clicked the currently sorted column again?
+                        switch(sorted) {            // -> cycle the sorting direction
+                            case SORT_UNSUPPORTED:  direction = SORT_UNSUPPORTED;   break;
+                            case SORT_UNSORTED:     direction = SORT_ASCENDING;     break;
+                            case SORT_ASCENDING:    direction = SORT_DESCENDING;    break;
+                            case SORT_DESCENDING:   direction = SORT_UNSORTED;      break;
+                        }
+                    }
+                    SetSorting(colDragId, direction);
+                }
+                colDrag = COLDRAG_NONE;
+                break;
+        }
+    }
+    
+    // Show a resize cursor over column borders
+    /// X-Plane has no resize cursor, so we hide the cursor and draw our own in DoDraw()
+    XPLMCursorStatus ListBox::DoHandleCursor (Point p)
+    {
+        size_t visIdx = 0;
+        bCursorResize =
+            colDrag == COLDRAG_RESIZE ||
+            (colDrag == COLDRAG_NONE &&
+             p.y() >= -int(lnHeight) &&
+             FindColBorder(p.x(), visIdx));
+        
+        // the cursor is drawn by us,
+        // so the area of where it is and where it was needs to be drawn anew
+        if (bCursorResize || bCursorDrawn) {
+            const Point c = Tl() + p, cPrev = Tl() + cursorPos;
+            const int sz = RESIZE_CURSOR_SIZE + 1;
+            if (bCursorDrawn)
+                mainWnd.AddDamage(Rect(cPrev.x()-sz, cPrev.y()+sz, cPrev.x()+sz, cPrev.y()-sz));
+            if (bCursorResize)
+                mainWnd.AddDamage(Rect(c.x()-sz, c.y()+sz, c.x()+sz, c.y()-sz));
+        }
+        cursorPos = p;
+        return bCursorResize ? xplm_CursorHidden : xplm_CursorDefault;
+    }
+    
+    // Handle cursor keys to change selection and scroll list, other characters search rows (type-ahead)
+    void ListBox::DoHandleKey (char inKey, XPLMKeyFlags inFlags, unsigned char inVirtualKey)
+    {
+        // left/right scroll horizontally
+        if ((inVirtualKey == XPLM_VK_LEFT || inVirtualKey == XPLM_VK_RIGHT) &&
+            inFlags == xplm_DownFlag)
+        {
+            if (inVirtualKey == XPLM_VK_RIGHT)
+                SetFirstCol(colFirst + 1);
+            else if (colFirst > GetFrozenEnd())
+                SetFirstCol(colFirst - 1);
+            return;
+        }
+        
+        // with no rows I can't do much
+        if (rows.empty()) return;
+        
+        // Ctrl-A selects all rows in a multi-selection list
+        if (bMultiSel && inVirtualKey == XPLM_VK_A &&
+            inFlags == (xplm_DownFlag | xplm_ControlFlag))
+        {
+            SelectAll();
+            mainWnd.MsgListSelRangeChanged(*this, 0, rows.size()-1);
+            return;
+        }
+        
+        // printable characters search for a row (type-ahead),
+        // unless they are part of a shortcut or a navigation key
+        const unsigned char c = (unsigned char)inKey;
+        if (c >= ' ' && c != 0x7F &&
+            (inFlags & (xplm_DownFlag | xplm_ControlFlag | xplm_OptionAltFlag)) == xplm_DownFlag &&
+            inVirtualKey != XPLM_VK_UP && inVirtualKey != XPLM_VK_DOWN &&
+            (inVirtualKey < XPLM_VK_PRIOR || inVirtualKey > XPLM_VK_HOME))
+        {
+            // after a pause we start searching anew
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (now - typeLast > std::chrono::milliseconds(TYPE_AHEAD_TIMEOUT_MS))
+                typePrefix.clear();
+            typeLast = now;
+            typePrefix += char(c);
+            SelectByPrefix(typePrefix);
+            return;
+        }
+        
+        // currently selected item
+        ListRowVecTy::iterator iter = rows.end();
+        if (selRefCon)
+            FindRowIdx(selRefCon, iter);
+        
+        // navigation keys can come with Shift to extend the selection
+        const XPLMKeyFlags navFlags = inFlags & ~xplm_ShiftFlag;
+        
+        // select next line?
+        if ( inVirtualKey == XPLM_VK_DOWN && navFlags == xplm_DownFlag ) {
+            if (iter == rows.end())             // none selected yet
+                iter = rows.begin();            // -> select first row
+            else if (std::next(iter) != rows.cend())
+                ++iter;                         // next, if there is a next
+        }
+
+        // select previous line?
+        else if ( inVirtualKey == XPLM_VK_UP && navFlags == xplm_DownFlag ) {
+            if (iter == rows.end())             // none selected yet
+                iter = rows.begin();            // -> select first row
+            else if (iter != rows.cbegin())
+                --iter;                         // previous, if there is a next
+        }
+        
+        // jump a page or to either end?
+        else if ((inVirtualKey >= XPLM_VK_PRIOR && inVirtualKey <= XPLM_VK_HOME) &&
+                 navFlags == xplm_DownFlag)
+        {
+            // compute the new row index directly and scroll along with it
+            const unsigned page = std::max(rowMax, 1u);
+            const size_t last = rows.size() - 1;
+            size_t idx = iter == rows.end() ? 0 : size_t(iter - rows.begin());
+            switch (inVirtualKey) {
+                case XPLM_VK_NEXT:
+                    idx = std::min(idx + page, last);
+                    SetScrollPos(scrollY + GetViewHeight());
+                    break;
+                case XPLM_VK_PRIOR:
+                    idx = idx > page ? idx - page : 0;
+                    SetScrollPos(scrollY - GetViewHeight());
+                    break;
+                case XPLM_VK_HOME:
+                    idx = 0;
+                    SetScrollPos(0);
+                    break;
+                default:                        // XPLM_VK_END
+                    idx = last;
+                    SetScrollPos(GetMaxScrollPos());
+                    break;
+            }
+            iter = rows.begin() + std::ptrdiff_t(idx);
+        }
+        
+        // no navigation key, which would change the selection
+        else
+            return;
+        
+        // select the selected row, with Shift extend the range from the anchor
+        ListRowVecTy::iterator iterAnchor;
+        if (iter == rows.end())
+            selRefCon = nullptr;
+        else if (bMultiSel && (inFlags & xplm_ShiftFlag) && FindRowIdx(selAnchor, iterAnchor))
+            DoSelectRange(size_t(iterAnchor - rows.begin()), size_t(iter - rows.begin()));
+        else
+            DoSelectRow(*iter);
+        MakeSelVisible();
+    }
+    
+    
+    // Scroll up/down, or left/right with the horizontal wheel
+    void ListBox::DoMouseWheel (Point /*p*/, int wheel, int clicks)
+    {
+        // horizontal wheel axis scrolls columns
+        if (wheel == 1) {
+            const int fc = int(colFirst) + clicks;
+            SetFirstCol(fc > 0 ? size_t(fc) : 0);
+            return;
+        }
+        // otherwise we only handle the vertical wheel axis
+        if (wheel != 0) return;
+        
+        // Each click adds velocity to travel one row in total,
+        // the actual movement happens over the next frames, see DoScrollInertia()
+        if (std::abs(scrollVel) <= 0.0f) {
+            scrollLast = std::chrono::steady_clock::now();
+            scrollRemain = 0.0f;
+        }
+        scrollVel += float(clicks * int(lnHeight)) / SCROLL_INERTIA_TAU;
+    }
+    
+    // Account for a string, which is in use or only keeps its storage
+    void ListMemStatsTy::Add (const std::string& _s, bool _bInUse)
+    {
+        // short strings are stored inside the string object, which is accounted for with its row
+        static const size_t SSO_CAPACITY = std::string().capacity();
+        if (_s.capacity() > SSO_CAPACITY) {
+            numHeapBlocks++;
+            bytesReserved += _s.capacity() + 1;
+            if (_bInUse)
+                bytesUsed += _s.size() + 1;
+        }
+    }
+    
+    // Account for a croppable string
+    void ListMemStatsTy::Add (const CroppedString& _s, bool _bInUse)
+    {
+        Add(_s.sFull, _bInUse);
+        Add(_s.sCropped, _bInUse && !_s.IsUncropped());
+    }
+    
+    // Account for a row and its values
+    void ListMemStatsTy::Add (const ListRow& _row, bool _bInUse)
+    {
+        if (_row.capacity()) {
+            numHeapBlocks++;
+            bytesReserved += _row.capacity() * sizeof(ListItem);
+            if (_bInUse)
+                bytesUsed += _row.size() * sizeof(ListItem);
+        }
+        for (const ListItem& item: _row) {
+            Add(item.sVal, _bInUse);
+            Add(item.sKey, _bInUse && item.keyColl != COLL_BINARY);
+        }
+    }
+    
+    //
+    // MARK: Tree List Box
+    //
+    
+    // constructor adds widget to main window
+    TreeListBox::TreeListBox (const std::string& _caption,
+                              MainWnd& main,
+                              WidgetPosE lR, int lO,
+                              WidgetPosE tR, int tO,
+                              WidgetPosE rR, int rO,
+                              WidgetPosE bR, int bO) :
+    ListBox(_caption, main, lR, lO, tR, tO, rR, rO, bR, bO)
+    {}
+    
+    // Define if a row can have children
+    void TreeListBox::SetHasChildren (void* _refCon, bool _b)
+    {
+        if (_b) {
+            if (nodes.emplace(_refCon, NodeTy()).second)
+                SetDirty();                     // now shows an expand marker
+            return;
+        }
+        
+        // no more children: hide and forget them
+        if (!nodes.count(_refCon))
+            return;
+        ListRowVecTy hidden;
+        ListRowVecTy* pBlock = nullptr;
+        ListRowVecTy::iterator iter;
+        if (FindRowIdx(_refCon, iter)) {
+            SetDirty();
+            Collapse(_refCon);
+        }
+        else if (FindHiddenRow(_refCon, pBlock, iter)) {
+            // under a collapsed ancestor, the descendants of an expanded row
+            // follow it in the ancestor's hidden block
+            const ListRowVecTy::iterator first = std::next(iter);
+            ListRowVecTy::iterator last = first;
+            while (last != pBlock->end() && last->level > iter->level)
+                ++last;
+            hidden.assign(std::make_move_iterator(first),
+                          std::make_move_iterator(last));
+            pBlock->erase(first, last);
+        }
+        
+        // a collapsed row keeps its descendants in its own node
+        std::unordered_map<void*,NodeTy>::iterator n = nodes.find(_refCon);
+        if (n != nodes.end()) {
+            hidden.insert(hidden.end(),
+                          std::make_move_iterator(n->second.hidden.begin()),
+                          std::make_move_iterator(n->second.hidden.end()));
+            nodes.erase(n);
+        }
+        DoDiscardRows(hidden.begin(), hidden.end());
+    }
+    
+    // Is the row expanded?
+    bool TreeListBox::IsExpanded (void* _refCon) const
+    {
+        std::unordered_map<void*,NodeTy>::const_iterator n = nodes.find(_refCon);
+        return n != nodes.end() && n->second.bExpanded;
+    }
+    
+    // Show a row's children, fetching them first if needed
+    bool TreeListBox::Expand (void* _refCon)
+    {
+        std::unordered_map<void*,NodeTy>::iterator n = nodes.find(_refCon);
+        ListRowVecTy::iterator iter;
+        if (n == nodes.end() || n->second.bExpanded || !FindRowIdx(_refCon, iter))
+            return false;
+        // (references to map elements survive nodes added by the main window)
+        NodeTy& node = n->second;
+        
+        // upon first expansion we ask the main window for the children
+        if (!node.bFetched) {
+            node.bFetched = true;
+            mainWnd.MsgTreeListFetchChildren(*this, *iter, node.hidden);
+            // the main window might have changed rows
+            if (!FindRowIdx(_refCon, iter))
+                return false;
+            for (ListRow& child: node.hidden) {
+                child.level = iter->level + 1;
+                DoUpdateKeys(child);
+                DoAdoptRow(child);
             }
         }
+        
+        // sorting might have changed while collapsed
+        if (sortedBy < cols.size())
+            DoSortForest(node.hidden, 0, node.hidden.size());
+        
+        // insert the descendants as one block right after the row
+        SetDirty();
+        for (ListRow& row: node.hidden)
+            DoIndexRow(row);
+        rows.insert(std::next(iter),
+                    std::make_move_iterator(node.hidden.begin()),
+                    std::make_move_iterator(node.hidden.end()));
+        node.hidden.clear();
+        node.bExpanded = true;
+        bRowTopsDirty = true;
+        bTypeIdxDirty = true;
+        return true;
     }
     
-    
-    // Draw a list box's vertical scrollbar
-    void ListBox::DoDrawVertScrollbar (const Rect& _r)
+    // Hide a row's children
+    bool TreeListBox::Collapse (void* _refCon)
     {
-        // Scrollbar is on right hand side, one character spacing thick
-        Rect sbRect(_r);
-        sbRect.Left() = sbRect.Right() - gCHAR_AVG_WIDTH;
-        sbRect.Top() -= int(lnHeight);
+        std::unordered_map<void*,NodeTy>::iterator n = nodes.find(_refCon);
+        ListRowVecTy::iterator iter;
+        if (n == nodes.end() || !n->second.bExpanded || !FindRowIdx(_refCon, iter))
+            return false;
         
-        // background
-        SetColor(gCOL_STD[COL_SCROLLBAR_BG]);
-        DrawRect(sbRect);
+        // the visible descendants directly follow the row, all on deeper levels
+        SetDirty();
+        const ListRowVecTy::iterator first = std::next(iter);
+        ListRowVecTy::iterator last = first;
+        bool bCurrHidden = false;
+        for (; last != rows.end() && last->level > iter->level; ++last) {
+            // hidden rows are not selected
+            SetSelBit(last->slot, false);
+            if (selRefCon == last->refCon)
+                bCurrHidden = true;
+            if (selAnchor == last->refCon)
+                selAnchor = _refCon;
+            DoUnindexRow(*last);
+        }
         
-        // thumb, depends on visible portion of list items
-        const int height = sbRect.Height();
-        const int top = _r.Top();
-        sbThumbTop      = - int(lnHeight) - (height * int(rowFirst       )) / int(rows.size());
-        sbThumbBottom   = - int(lnHeight) - (height * int(rowFirst+rowMax)) / int(rows.size());
-        sbRect.Top()   = top + sbThumbTop;
-        sbRect.SetBottom(top + sbThumbBottom);
+        // move the block out of the visible rows into the node
+        NodeTy& node = n->second;
+        node.hidden.assign(std::make_move_iterator(first),
+                           std::make_move_iterator(last));
+        rows.erase(first, last);
+        node.bExpanded = false;
+        bRowTopsDirty = true;
+        bTypeIdxDirty = true;
+        DoScrollTo(scrollY);
         
-        // reduce size of all edges by 1 to leave a tiny frame around
-        // where the background stays visible
-        sbRect.Expand(-1);
+        // if the current row got hidden then its ancestor becomes the current row
+        if (bCurrHidden) {
+            SetSelBit(iter->slot, true);
+            selRefCon = _refCon;
+            mainWnd.MsgListSelChanged(*this, *iter);
+        }
+        return true;
+    }
+    
+    // Remove a row's children, so they are fetched anew upon next expansion
+    void TreeListBox::Refresh (void* _refCon)
+    {
+        if (!nodes.count(_refCon))
+            return;
+        const bool bWasExpanded = Collapse(_refCon);
+        NodeTy& node = nodes[_refCon];
+        ListRowVecTy hidden = std::move(node.hidden);
+        node = NodeTy();
+        DoDiscardRows(hidden.begin(), hidden.end());
+        if (bWasExpanded)
+            Expand(_refCon);
+    }
+    
+    // Add/update a row
+    ListRow& TreeListBox::AddRow (ListRow&& row)
+    {
+        ListRowVecTy* pBlock = nullptr;
+        ListRowVecTy::iterator iter;
+        if (!FindHiddenRow(row.refCon, pBlock, iter))
+            return ListBox::AddRow(std::move(row));
         
-        SetColor(gCOL_STD[COL_SCROLLBAR_FG]);
-        DrawRect(sbRect);
+        // a hidden row gets indexed and sorted when shown again
+        DoUpdateHiddenRow(*iter, std::move(row));
+        return *iter;
     }
     
-
-    // Re-sort the existing list of rows according to sorting criteria
-    void ListBox::DoSort ()
+    // Add/update many rows at once
+    void TreeListBox::AddRows (ListRowVecTy&& newRows)
     {
-        // sanity check that column-to-sort-by exists
-        if (sortedBy >= cols.size()) return;
-        const DataTypeTy _dataType = cols[sortedBy].dataType;
-
-        // re-sort the list of rows
-        std::sort(rows.begin(), rows.end(),
-                  [this,_dataType](const ListRow& r1, const ListRow& r2)->bool
-                  { return r1.elemLess(r2, sortedBy, sorted, _dataType); });
+        // index of all hidden rows, which are updated in place
+        std::unordered_map<void*,ListRow*> hiddenIdx;
+        for (std::pair<void* const,NodeTy>& n: nodes)
+            for (ListRow& row: n.second.hidden)
+                hiddenIdx.emplace(row.refCon, &row);
         
-        // Make selected row still visible
-        MakeSelVisible();
+        if (!hiddenIdx.empty()) {
+            ListRowVecTy::iterator keep = newRows.begin();
+            for (ListRow& row: newRows) {
+                std::unordered_map<void*,ListRow*>::iterator h = hiddenIdx.find(row.refCon);
+                if (h != hiddenIdx.end())
+                    DoUpdateHiddenRow(*h->second, std::move(row));
+                else
+                    *keep++ = std::move(row);
+            }
+            newRows.erase(keep, newRows.end());
+        }
+        ListBox::AddRows(std::move(newRows));
     }
     
+    // Remove a visible row including all its descendants
+    bool TreeListBox::RemoveRow (void* _refCon)
+    {
+        if (!FindRow(_refCon))
+            return false;
+        SetHasChildren(_refCon, false);
+        return ListBox::RemoveRow(_refCon);
+    }
     
-    // define the new selected row and inform the main window
-    void ListBox::DoSelectRow (ListRow& _selRow)
+    // Remove all selected rows including all their descendants
+    size_t TreeListBox::RemoveSelected ()
     {
-        selRefCon = _selRow.refCon;
-        mainWnd.MsgListSelChanged(*this, _selRow);
-
+        // selected rows are visible, their descendants become hidden and are forgotten
+        for (void* refCon: GetSelectedRefCons())
+            SetHasChildren(refCon, false);
+        return ListBox::RemoveSelected();
     }
-
     
-    // Find vector index by refCon
-    bool ListBox::FindRowIdx (void* _refCon,
-                              ListRowVecTy::const_iterator& iter) const
+    // Clear a list: Remove all rows
+    void TreeListBox::Clear ()
     {
-        // search the vector by refCon
-        iter = std::find_if (rows.cbegin(), rows.cend(),
-                             [_refCon](const ListRow& r)
-                             { return r.refCon == _refCon; });
-        // found something?
-        return iter != rows.cend();
+        nodes.clear();
+        ListBox::Clear();
     }
     
-    // Find vector index by refCon
-    bool ListBox::FindRowIdx (void* _refCon,
-                              ListRowVecTy::iterator& iter)
+    // Indentation by nesting level, plus room for the expansion marker
+    int TreeListBox::GetRowIndent (const ListRow& row) const
     {
-        // search the vector by refCon
-        iter = std::find_if (rows.begin(), rows.end(),
-                             [_refCon](const ListRow& r)
-                             { return r.refCon == _refCon; });
-        // found something?
-        return iter != rows.end();
+        return int(row.level + 1) * TREE_INDENT_CHARS * gCHAR_AVG_WIDTH;
     }
     
+    // Sort siblings within their parents
+    void TreeListBox::DoSortRows ()
+    {
+        DoSortForest(rows, 0, rows.size());
+    }
     
-    // Find row by y coordinate, relative to top of list box
-    bool ListBox::FindRowIdx (int _y, ListRowVecTy::iterator& iter)
+    // Sort the flattened trees in `_v[_first, _last)` recursively
+    /// Each tree, i.e. a row and the rows following it on deeper levels,
+    /// is sorted internally first, then the trees are ordered by their top rows.
+    void TreeListBox::DoSortForest (ListRowVecTy& _v, size_t _first, size_t _last)
     {
-        // _y needs to be negative: it's relative from top, and downward is negative
-        if (_y > 0) { iter = rows.end(); return false; }
-        
-        // which visible row did we hit?
-        unsigned rowHit = unsigned(-_y) / lnHeight;
+        if (_last - _first < 2)
+            return;
         
-        // Hit the header row?
-        if (rowHit == 0) {
-            iter = rows.end();
-            return false;
+        // find the trees, each spans [first, second) of `_v`
+        const unsigned level = _v[_first].level;
+        std::vector<std::pair<size_t,size_t>> trees;
+        for (size_t i = _first; i < _last; ) {
+            size_t end = i + 1;
+            while (end < _last && _v[end].level > level)
+                ++end;
+            DoSortForest(_v, i + 1, end);
+            trees.emplace_back(i, end);
+            i = end;
         }
-
-        // remove the header from calculation
-        rowHit--;
-        // add the lines hidden due to scrolling into the calculation
-        rowHit += rowFirst;
+        if (trees.size() < 2)
+            return;
         
-        // If this now is in range of number of rows we have, then we found it
-        if (rowHit < rows.size()) {
-            iter = rows.begin();
-            std::advance(iter, rowHit);
-            return true;
-        }
-
-        // clicked after all rows
-        iter = rows.end();
-        return false;
+        // order the trees by their top rows
+        std::sort(trees.begin(), trees.end(),
+                  [this,&_v](const std::pair<size_t,size_t>& t1, const std::pair<size_t,size_t>& t2)->bool
+                  { return RowLess(_v[t1.first], _v[t2.first]); });
+        
+        // move the rows into their new order
+        ListRowVecTy sortedRows;
+        sortedRows.reserve(_last - _first);
+        for (const std::pair<size_t,size_t>& t: trees)
+            for (size_t i = t.first; i < t.second; ++i)
+                sortedRows.emplace_back(std::move(_v[i]));
+        std::move(sortedRows.begin(), sortedRows.end(), _v.begin() + std::ptrdiff_t(_first));
     }
-
-
-    // Find column by x coordinate, relative to top of list box
-    unsigned ListBox::FindColIdx (int _x)
+    
+    // Find a row hidden under a collapsed ancestor
+    bool TreeListBox::FindHiddenRow (void* _refCon, ListRowVecTy*& _pBlock, ListRowVecTy::iterator& iter)
     {
-        if (cols.empty())               // sanity check
-            return 0;
-        
-        int right = 0;                  // will become the columns right x coordinate
-        size_t lastVisibleCol = 0;
-        for (size_t col = 0;
-             col < cols.size();
-             col++)
-        {
-            if (cols.at(col).bVisible) {
-                right += cols.at(lastVisibleCol=col).width;
-                if (_x <= right)        // if x is now left of right border return this column
-                    return (unsigned)col;
+        for (std::pair<void* const,NodeTy>& n: nodes) {
+            ListRowVecTy& hidden = n.second.hidden;
+            iter = std::find_if(hidden.begin(), hidden.end(),
+                                [_refCon](const ListRow& r)
+                                { return r.refCon == _refCon; });
+            if (iter != hidden.end()) {
+                _pBlock = &hidden;
+                return true;
             }
         }
-        // default: return last visible column
-        return (unsigned)lastVisibleCol;
+        return false;
     }
     
+    // Overwrite a hidden row's data with `row`'s, keeping the hidden row's identity
+    void TreeListBox::DoUpdateHiddenRow (ListRow& _hidden, ListRow&& row)
+    {
+        DoUpdateKeys(row);
+        row.SetSequNr(_hidden.GetSequNr());
+        row.slot = _hidden.slot;
+        row.level = _hidden.level;
+        // swap instead of move-assign, so that the old row's storage can be reused
+        std::swap(_hidden, row);
+        RetireRow(std::move(row));
+    }
     
-    // Ensure that the selected row, if any, is scrolled into visibility
-    void ListBox::MakeSelVisible ()
+    // Forget rows: free their slots and drop their tree nodes including hidden descendants
+    /// Only used for hidden rows, which are not accounted for in width histograms
+    void TreeListBox::DoDiscardRows (ListRowVecTy::iterator _first, ListRowVecTy::iterator _last)
     {
-        if (selRefCon) {
-            ListRowVecTy::const_iterator iter;
-            if (FindRowIdx(selRefCon, iter)) {
-                const unsigned rowSel = (unsigned)std::distance(rows.cbegin(), iter);
-                if (rowSel < rowFirst)          // selected before first visible row
-                    rowFirst = rowSel;
-                    else if (rowSel >= rowFirst + rowMax) // selected past last visible row
-                        rowFirst = rowSel - rowMax + 1;
+        for (; _first != _last; ++_first) {
+            FreeSlot(_first->slot);
+            std::unordered_map<void*,NodeTy>::iterator n = nodes.find(_first->refCon);
+            if (n != nodes.end()) {
+                ListRowVecTy hidden = std::move(n->second.hidden);
+                nodes.erase(n);
+                DoDiscardRows(hidden.begin(), hidden.end());
             }
         }
     }
     
-    
-    // Change selected row upon mouse click
-    void ListBox::DoMouseClick (Point p, MouseBtnTy mouseBtn, XPLMMouseStatus inMouse)
+    // Draw the row and its expansion marker
+    void TreeListBox::DoDrawRow (const Rect& rowRect, ListRow& row, const float txtColor[4])
     {
-        // we only handle the left-button-mouse-down-event
-        if (mouseBtn != MOUSE_LEFT || inMouse != xplm_MouseDown)
-            return;
-        
-        // Into which column was the click?
-        unsigned col = FindColIdx(p.x());
-        
-        // clicked into the header?
-        if (p.y() >= -int(lnHeight)) {
-            if (sorted != SORT_UNSUPPORTED) {
-                // Sort by the column we hit
-                SortingTy direction = SORT_ASCENDING;
-                if (col == sortedBy) {          // clicked the currently sorted column again?
-                    switch(sorted) {            // -> cycle the sorting direction
-                        case SORT_UNSUPPORTED:  direction = SORT_UNSUPPORTED;   break;
-                        case SORT_UNSORTED:     direction = SORT_ASCENDING;     break;
-                        case SORT_ASCENDING:    direction = SORT_DESCENDING;    break;
-                        case SORT_DESCENDING:   direction = SORT_UNSORTED;      break;
-                    }
-                }
-                SetSorting(col, direction);
-            }
-            return;
-        }
+        ListBox::DoDrawRow(rowRect, row, txtColor);
         
-        // if there is a scrollbar then we need to check scrollbar clicks, too
-        if (rows.size() > rowMax && p.x() >= Width() - gCHAR_AVG_WIDTH)
-        {
-            if (p.y() >= sbThumbTop)            // scroll one page up
-                DoMouseWheel(p, 0, rowMax > 1 ? -int(rowMax)+1 : -1);
-            else if (p.y() <= sbThumbBottom)    // scroll one page down
-                DoMouseWheel(p, 0, rowMax > 1 ? int(rowMax)-1  :  1);
-            // TODO: Handle dragging of thumb
+        // the marker is part of the left-most column
+        std::unordered_map<void*,NodeTy>::const_iterator n = nodes.find(row.refCon);
+        if (FirstDrawCol() > 0 || n == nodes.end())
             return;
-        }
         
-        // find the affected row of the list box
-        ListRowVecTy::iterator iter;
-        if (FindRowIdx(p.y(), iter)) {
-            // if we hit a Checkbox column in that row
-            if (col < cols.size() && cols.at(col).dataType == DTY_CHECKBOX &&
-                col < iter->size())
-            {
-                // toggle the "checked" status if that item is enabled
-                ListItem& li = iter->at(col);
-                if (li.IsEnabled())
-                    li.Set(!li.IsSet());
-            }
-            // Select the row
-            DoSelectRow(*iter);
-        }
+        // a triangle pointing right (collapsed) or down (expanded)
+        const int indent = TREE_INDENT_CHARS * gCHAR_AVG_WIDTH;
+        const int s = std::min(indent, rowRect.Height()) / 3;
+        const Point c (rowRect.Left() + int(row.level) * indent + indent/2,
+                       (rowRect.Top() + rowRect.Bottom()) / 2);
+        DrawSetColor(txtColor);
+        if (n->second.bExpanded)
+            DrawPolygon({ Point(c.x()-s, c.y()+s/2), Point(c.x()+s, c.y()+s/2), Point(c.x(), c.y()-s) });
+        else
+            DrawPolygon({ Point(c.x()-s/2, c.y()+s), Point(c.x()+s/2+1, c.y()), Point(c.x()-s/2, c.y()-s) });
     }
     
-    
-    // Handle cursor keys to change selection and scroll list
-    void ListBox::DoHandleKey (char /*inKey*/, XPLMKeyFlags inFlags, unsigned char inVirtualKey)
+    // A click on the expansion marker expands/collapses the row
+    void TreeListBox::DoMouseClick (Point p, MouseBtnTy mouseBtn, XPLMMouseStatus inMouse)
     {
-        // with no rows I can't do much
-        if (rows.empty()) return;
-        
-        // currently selected item
-        ListRowVecTy::iterator iter = rows.end();
-        if (selRefCon)
-            FindRowIdx(selRefCon, iter);
-        
-        // select next line?
-        if ( inVirtualKey == XPLM_VK_DOWN && inFlags == xplm_DownFlag ) {
-            if (iter == rows.end())             // none selected yet
-                iter = rows.begin();            // -> select first row
-            else if (std::next(iter) != rows.cend())
-                ++iter;                         // next, if there is a next
-        }
-
-        // select previous line?
-        else if ( inVirtualKey == XPLM_VK_UP && inFlags == xplm_DownFlag ) {
-            if (iter == rows.end())             // none selected yet
-                iter = rows.begin();            // -> select first row
-            else if (iter != rows.cbegin())
-                --iter;                         // previous, if there is a next
+        ListRowVecTy::iterator iter;
+        if (mouseBtn == MOUSE_LEFT && inMouse == xplm_MouseDown &&
+            colDrag == COLDRAG_NONE && !bThumbDrag && FirstDrawCol() == 0 &&
+            FindRowIdx(p.y(), iter) && HasChildren(iter->refCon))
+        {
+            const int indent = TREE_INDENT_CHARS * gCHAR_AVG_WIDTH;
+            const int markerLeft = int(iter->level) * indent;
+            if (markerLeft <= p.x() && p.x() < markerLeft + indent) {
+                ToggleExpand(iter->refCon);
+                return;
+            }
         }
-        
-        // select the selected row
-        if (iter != rows.end())
-            DoSelectRow(*iter);
-        else
-            selRefCon = nullptr;
-        MakeSelVisible();
+        ListBox::DoMouseClick(p, mouseBtn, inMouse);
     }
     
-    
-    // Scroll up/down
-    void ListBox::DoMouseWheel (Point /*p*/, int wheel, int clicks)
+    // `+` and `-` expand and collapse the current row
+    void TreeListBox::DoHandleKey (char inKey, XPLMKeyFlags inFlags, unsigned char inVirtualKey)
     {
-        // we only handle the vertical wheel axis yet
-        if (wheel != 0) return;
-        
-        // adjust first shown row accordingly
-        int fr = int(rowFirst) + clicks;
-        if (fr < 0)
-            rowFirst = 0;
-        else if (fr > int(rowFirstMaxDown))
-            rowFirst = rowFirstMaxDown;
-        else
-            rowFirst = unsigned(fr);
+        if ((inKey == '+' || inKey == '-') && selRefCon &&
+            (inFlags & (xplm_DownFlag | xplm_ControlFlag | xplm_OptionAltFlag)) == xplm_DownFlag)
+        {
+            if (inKey == '+')
+                Expand(selRefCon);
+            else
+                Collapse(selRefCon);
+            return;
+        }
+        ListBox::DoHandleKey(inKey, inFlags, inVirtualKey);
     }
 
     //
@@ -2038,12 +4795,78 @@ namespace TFW {
         // stop the timer
         SetTimer(0.0f);
         
+        // free the offscreen copy
+        RenderCacheRelease(renderCache);
+        
         // remove the window also from XP
         if (wnd)
             XPLMDestroyWindow(wnd);
         wnd = NULL;
     }
     
+    // Draw widgets into an offscreen texture
+    void MainWnd::SetRenderCache (bool _bCache)
+    {
+        bRenderCache = _bCache;
+        if (!bRenderCache)
+            RenderCacheRelease(renderCache);
+        SetDirty();
+    }
+    
+    // Mark the window dirty, or clear the dirty state of the window and all its widgets
+    void MainWnd::SetDirty (bool _bDirty)
+    {
+        bDirty = _bDirty;
+        if (!_bDirty) {
+            for (WidgetAddTy& wa: widgets)
+                wa.w.SetDirty(false);
+            damage.clear();
+        }
+    }
+    
+    // Is the window or any of its visible widgets dirty?
+    bool MainWnd::IsDirty () const
+    {
+        if (Widget::IsDirty() || !damage.empty())
+            return true;
+        for (const WidgetAddTy& wa: widgets)
+            if (wa.w.IsVisible() && wa.w.IsDirty())
+                return true;
+        return false;
+    }
+    
+    // Mark an area, in widget coordinates, to be drawn anew
+    void MainWnd::AddDamage (const Rect& _r)
+    {
+        // everything is drawn anew anyway, or it is being drawn right now
+        if (bDirty || bDrawing)
+            return;
+        
+        // merge with all overlapping areas, so that areas stay disjoint
+        Rect r = _r;
+        for (size_t i = 0; i < damage.size(); ) {
+            const Rect& d = damage[i];
+            if (AreasIntersect(r, d)) {
+                r = Rect(std::min(r.Left(), d.Left()),   std::max(r.Top(), d.Top()),
+                         std::max(r.Right(), d.Right()), std::min(r.Bottom(), d.Bottom()));
+                damage.erase(damage.begin() + long(i));
+                i = 0;                          // merged area might now overlap earlier ones
+            }
+            else
+                i++;
+        }
+        
+        // too many areas make drawing them separately more expensive than drawing one
+        if (damage.size() >= DAMAGE_MAX_AREAS) {
+            for (const Rect& d: damage)
+                r = Rect(std::min(r.Left(), d.Left()),   std::max(r.Top(), d.Top()),
+                         std::max(r.Right(), d.Right()), std::min(r.Bottom(), d.Bottom()));
+            damage.clear();
+        }
+        damage.push_back(r);
+        damageCnt++;
+    }
+    
     // Set the window title
     void MainWnd::SetCaption (const std::string& _c)
     {
@@ -2052,6 +4875,15 @@ namespace TFW {
         // set the window's title
         XPLMSetWindowTitle(wnd, caption.full_str());
     }
+    
+    // Set the window title, taking over the string's buffer
+    void MainWnd::SetCaption (std::string&& _c)
+    {
+        // call base class first
+        Widget::SetCaption(std::move(_c));
+        // set the window's title
+        XPLMSetWindowTitle(wnd, caption.full_str());
+    }
 
     // Resizing means different things in different positioning modes
     /// @param _r Target coordinates, if window is popped out this shall be OS coordinates!
@@ -2226,6 +5058,9 @@ namespace TFW {
     /// position. That offset will be added during drawing only.
     void MainWnd::Layout ()
     {
+        // everything moves, so everything needs to be drawn anew
+        SetDirty();
+        
         // the order is the order in the deque
         const WidgetAddTy* prevWa = nullptr;
         for (WidgetAddTy& wa: widgets)
@@ -2324,6 +5159,15 @@ namespace TFW {
             resetPosModeTo = -1;
         }
         
+        // values, which stay the same for the entire frame, are fetched once now
+        frameCtx.Update();
+        gCHAR_AVG_WIDTH = frameCtx.GetFont(xplmFont_Proportional).charWidth;
+        gpFrameCtx = &frameCtx;
+        if (xpColorsGenDrawn != frameCtx.GetXPColorsGen()) {
+            xpColorsGenDrawn = frameCtx.GetXPColorsGen();
+            SetDirty();
+        }
+        
         // define graphic state for all drawing once
         XPLMSetGraphicsState(0,             // fog
                              0,             // number tex units
@@ -2332,17 +5176,112 @@ namespace TFW {
                              1,             // alpha blend
                              0,             // depth test
                              0);            // depth write
+        // matrices, viewport, and scissor state are read once, too
+        DrawFrameBegin();
         
-        // draw my own background
-        DrawBackground(*this);
+        // with the first window drawn rasterize the font atlas, using our own area as scratch space
+        if (gbTextAtlas && !TextAtlasReady(xplmFont_Proportional))
+            TextAtlasBuild(*this, xplmFont_Proportional, TEXT_OFS);
         
         // Offset all drawing starts from
         const Point Ofs = Tl() + Point(frameThick,-frameThick);
+        DoCollectDamage();
+        bDrawing = true;
+        
+        // Changes not caused by the user wait until the refresh interval has passed
+        const bool bThrottled =
+            maxRefreshRate > 0.0f && !bRefreshNow &&
+            frameCtx.now - lastRefresh < std::chrono::duration<float>(1.0f / maxRefreshRate);
+        
+        // Draw into the cache, or directly if not possible
+        bool bCaching = false;
+        bool bPresentOnly = false;
+        if (bRenderCache) {
+            const bool bAll = Widget::IsDirty();
+            // Nothing changed, or not yet time to show changes? Then just present the cached drawing
+            if (!bAll && (damage.empty() || bThrottled) && RenderCacheDraw(renderCache, *this)) {
+                bPresentOnly = true;
+            }
+            // Only some areas changed? Then just draw those anew
+            else if (!bAll && RenderCacheFits(renderCache, *this) &&
+                     RenderCacheBegin(renderCache, *this, true))
+            {
+                for (const Rect& d: damage) {
+                    const Rect area (d + Ofs);
+                    DrawPushClip(area);
+                    DrawClearClip();
+                    DoDrawWidgets(Ofs, &area);
+                    DrawPopClip();
+                }
+                bCaching = true;
+            }
+            // Draw everything anew
+            else {
+                bCaching = RenderCacheBegin(renderCache, *this);
+                if (!RenderCacheAvail())
+                    bRenderCache = false;       // no framebuffer objects: fall back to drawing directly
+                DoDrawWidgets(Ofs);
+            }
+        }
+        else
+            DoDrawWidgets(Ofs);
+        
+        // draw all queued text
+        TextQueueFlush();
+        if (bCaching) {
+            RenderCacheEnd(renderCache);
+            RenderCacheDraw(renderCache, *this);
+        }
+        bDrawing = false;
+        // damage stays pending until drawn
+        if (!bPresentOnly) {
+            SetDirty(false);
+            lastRefresh = frameCtx.now;
+            bRefreshNow = false;
+        }
+        textStats = TextQueueTakeStats();
+        DrawFrameEnd();
+        gpFrameCtx = nullptr;
+    }
+    
+    // Add the areas of widgets, which are dirty or lost/gained focus, to `damage`
+    void MainWnd::DoCollectDamage ()
+    {
+        // the focus widget draws a focus border
+        const Widget* pFocus = GetFocusWidget();
+        if (pFocus != pFocusDrawn) {
+            if (pFocusDrawn)
+                AddDamage(focusDrawnRect);
+            if (pFocus)
+                AddDamage(*pFocus);
+            pFocusDrawn = pFocus;
+            bRefreshNow = true;
+        }
+        if (pFocus)
+            focusDrawnRect = *pFocus;
+        
+        // widgets, which are dirty by themselves, e.g. a blinking caret,
+        // react to the user, so they are to be drawn immediately
+        for (const WidgetAddTy& wa: widgets)
+            if (wa.w.IsVisible() && wa.w.IsDirty()) {
+                AddDamage(wa.w);
+                if (wa.w.NeedsImmediateRedraw())
+                    bRefreshNow = true;
+            }
+    }
+    
+    // Draw the background and all widgets
+    void MainWnd::DoDrawWidgets (const Point& _ofs, const Rect* _pArea)
+    {
+        // draw my own background
+        DrawBackground(*this);
+        
         // draw all widgets
         for (WidgetAddTy& wa: widgets) {
             if (wa.w.IsVisible()) {                 // is widget visible?
-                const Rect drawRect (wa.w + Ofs);   // actual coordinate to draw
-                if (Contains(drawRect))             // and enough space to draw complete widget?
+                const Rect drawRect (wa.w + _ofs);  // actual coordinate to draw
+                if (Contains(drawRect) &&           // and enough space to draw complete widget?
+                    (!_pArea || AreasIntersect(*_pArea, drawRect)))
                     wa.w.DoDraw(drawRect);
             }
         }
@@ -2379,9 +5318,12 @@ namespace TFW {
             LocalizePoint(p, *pMouseFocusWidget);
         }
 
-        // now perform the click in the widget
-        if (pMouseFocusWidget)
+        // now perform the click in the widget, which probably changes its look
+        if (pMouseFocusWidget) {
+            bRefreshNow = true;
+            pMouseFocusWidget->w.SetDirty();
             pMouseFocusWidget->w.DoMouseClick(p, mouseBtn, inMouse);
+        }
         
         // in case of mouse up: clear the focus widget
         if (inMouse == xplm_MouseUp)
@@ -2393,13 +5335,19 @@ namespace TFW {
     {
         // find the affected widget and inform it
         WidgetAddDequeTy::iterator iter;
-        if (FindWidgetByPos(p, iter))
+        if (FindWidgetByPos(p, iter)) {
+            bRefreshNow = true;
+            iter->w.SetDirty();
             iter->w.DoMouseWheel(p, wheel, clicks);
+        }
     }
     
     // @see https://developer.x-plane.com/sdk/XPLMHandleKey_f/
     void MainWnd::DoHandleKey (char inKey, XPLMKeyFlags inFlags, unsigned char inVirtualKey)
     {
+        // the user wants to see the reaction immediately
+        bRefreshNow = true;
+        
         // Handle the [Tab] key for focus change between our widgets
         if (inVirtualKey == XPLM_VK_TAB) {
             // pressing TAB without any modifiers -> forward
@@ -2423,6 +5371,7 @@ namespace TFW {
         }
         // forward all other keys to the focus widget
         else if (pFocusWidget) {
+            pFocusWidget->w.SetDirty();
             pFocusWidget->w.DoHandleKey(inKey, inFlags, inVirtualKey);
         }
     }
@@ -2441,11 +5390,14 @@ namespace TFW {
     {
         // Being called means that the entire main window lost focus.
         // TODO: Find a way of calling this from outside when main window gains focus
-        if (_fcs == FCS_LOOSE && pFocusWidget)
+        if (_fcs == FCS_LOOSE && pFocusWidget) {
+            bRefreshNow = true;
             // inform focus widget that we (all) just lost it.
             // (But don't nullify the pointer: When main window gets focus back
             //  we continue with the same focus widget.)
+            pFocusWidget->w.SetDirty();
             pFocusWidget->w.DoFocusChange(FCS_LOOSE);
+        }
         
         // processed
         return true;
@@ -2456,8 +5408,14 @@ namespace TFW {
     {
         // find the affected widget and inform it
         WidgetAddDequeTy::iterator iter;
-        if (FindWidgetByPos(p, iter))
-            return iter->w.DoHandleCursor(p);
+        if (FindWidgetByPos(p, iter)) {
+            const unsigned long prevDamageCnt = damageCnt;
+            const XPLMCursorStatus ret = iter->w.DoHandleCursor(p);
+            // hovering changed the widget's look? Then show it immediately
+            if (damageCnt != prevDamageCnt)
+                bRefreshNow = true;
+            return ret;
+        }
         
         // just return the default
         return xplm_CursorDefault;
@@ -24,11 +24,19 @@
 #include "TFWGraphics.h"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <cstring>
 #include <deque>
+#include <functional>
+#include <map>
+#include <set>
+#include <unordered_map>
 #include <vector>
 #include "XPLMDisplay.h"
+#include "XPLMGraphics.h"
 
 // Windows
 // we prefer std::max/min of <algorithm>
@@ -120,6 +128,27 @@ namespace TFW {
         DTY_DOUBLE,                             ///< data type "double"
     };
     
+    /// Aggregate of a numeric list box column, shown in the footer row
+    enum AggregateTy {
+        AGG_NONE = 0,                           ///< no aggregate
+        AGG_COUNT,                              ///< number of values
+        AGG_SUM,                                ///< sum of all values
+        AGG_MIN,                                ///< smallest value
+        AGG_MAX,                                ///< largest value
+        AGG_MEAN,                               ///< arithmetic mean of all values
+    };
+    
+    /// Condition of a list box formatting rule
+    enum FormatCondTy {
+        FMT_LESS = 0,                           ///< value < threshold
+        FMT_LESS_EQUAL,                         ///< value <= threshold
+        FMT_GREATER,                            ///< value > threshold
+        FMT_GREATER_EQUAL,                      ///< value >= threshold
+        FMT_EQUAL,                              ///< value == threshold (string columns: equals the rule's string)
+        FMT_NOT_EQUAL,                          ///< value != threshold (string columns: differs from the rule's string)
+        FMT_RANGE,                              ///< threshold <= value < upper bound
+    };
+    
     /// Text Alignment
     enum TextAlignTy {
         TXA_LEFT = 0,                           ///< left aligned
@@ -135,6 +164,14 @@ namespace TFW {
         SORT_DESCENDING                         ///< sorted descendingly
     };
     
+    /// Collation, i.e. the ordering rules applied when sorting string values
+    enum CollationTy {
+        COLL_BINARY = 0,                        ///< byte order as per `std::string::operator<`, fastest, needs no collation key
+        COLL_NOCASE,                            ///< case-insensitive, accented latin letters sort with their base letter
+        COLL_NATURAL,                           ///< like COLL_NOCASE, plus embedded numbers compare by value, e.g. "A9" < "A10"
+        COLL_LOCALE,                            ///< as defined by the current C locale (`std::strxfrm`)
+    };
+    
     /// Button status types
     enum ButtonStateTy {
         BTN_NORMAL = 0,                         ///< normal state, released
@@ -158,6 +195,40 @@ namespace TFW {
         FCS_PREV,                               ///< widget shall activate previous focus field (if it manage several focus fields) or release focus if it has none resp. reached the first self-managed field
     };
     
+    /// Dimensions of a font, see FrameContext::GetFont()
+    struct FontMetricsTy {
+        int charWidth = 8;                      ///< average character width
+        int charHeight = 10;                    ///< character height
+        bool bValid = false;                    ///< fetched in the current frame?
+    };
+    
+    /// @brief Values, which stay the same during a drawing frame, fetched once per frame by MainWnd::DoDraw()
+    /// @details Widgets read font metrics, X-Plane's standard colors, and the time
+    ///          from here while drawing instead of querying the SDK or the clock themselves.
+    ///          See MainWnd::GetFrameContext().
+    class FrameContext
+    {
+    protected:
+        std::array<FontMetricsTy,xplmFont_Proportional+1> fonts;   ///< font metrics, indexed by `XPLMFontID`, fetched on first use in a frame
+        FontMetricsTy fontOther;                                    ///< metrics of any other font, fetched on each use
+        std::array<std::array<float,3>,COL_XP_COUNT> xpColors;      ///< X-Plane's standard colors
+        unsigned long xpColorsGen = 0;                              ///< increased whenever X-Plane's standard colors change
+    public:
+        std::chrono::steady_clock::time_point now;  ///< the frame's time
+        unsigned long frameNr = 0;                  ///< number of frames drawn so far
+        unsigned xpColorsRefresh = 1;               ///< fetch X-Plane's standard colors every so many frames
+    public:
+        /// Start a new frame: take the time and, if due, fetch X-Plane's standard colors
+        void Update ();
+        /// Dimensions of a font, fetched only once per frame
+        const FontMetricsTy& GetFont (XPLMFontID _fontId);
+        /// One of X-Plane's standard colors (RGB)
+        const float* GetXPColor (XPStdColorsE _colId) const { return xpColors[size_t(_colId)].data(); }
+        /// @brief Generation of X-Plane's standard colors, increases only if any of them actually changed
+        /// @details Widgets, which cache translated colors, need to translate them again when this value changes.
+        unsigned long GetXPColorsGen () const { return xpColorsGen; }
+    };
+    
     //
     // MARK: Croppable Text
     //
@@ -165,11 +236,14 @@ namespace TFW {
     /// @brief Holds a string plus its cropped version
     /// @details Avoids using expensive clipping operations during UI draw,
     ///          instead the clipped text is computed once only.
+    ///          As long as no width is set the cropped string is the full string,
+    ///          which then is not duplicated.
     class CroppedString
     {
+        friend struct ListMemStatsTy;
     protected:
         std::string     sFull;          ///< full string
-        std::string     sCropped;       ///< cropped string
+        std::string     sCropped;       ///< cropped string, unused while IsUncropped()
         size_t          width;          ///< cropping width in pixels
         size_t          startPos = 0;   ///< starting position into sFull
     public:
@@ -180,7 +254,7 @@ namespace TFW {
         sFull(_s), width(_width), startPos(_start)
         { UpdateCroppedString(); }
         /// Constructor, which moves a string into `sFull`
-        CroppedString (std::string&& _s, size_t _width, size_t _start=0) :
+        CroppedString (std::string&& _s, size_t _width=UINT64_MAX, size_t _start=0) :
         sFull(std::move(_s)), width(_width), startPos(_start)
         { UpdateCroppedString(); }
         
@@ -199,9 +273,9 @@ namespace TFW {
         /// Return the full string as C string
         const char* full_str() const { return sFull.c_str(); }
         /// Return the cropped string
-        const std::string& cropped() const { return sCropped; }
+        const std::string& cropped() const { return IsUncropped() ? sFull : sCropped; }
         /// Return the cropped string as C string
-        const char* cropped_str() const { return sCropped.c_str(); }
+        const char* cropped_str() const { return cropped().c_str(); }
 
         /// Set a new string
         CroppedString& operator = (const std::string& _o)
@@ -209,6 +283,9 @@ namespace TFW {
         /// Move a new string
         CroppedString& operator = (std::string&& _o)
         { sFull = std::move(_o); UpdateCroppedString(); return *this; }
+        /// Set a new C string, reusing the existing storage
+        CroppedString& operator = (const char* _o)
+        { sFull = _o; UpdateCroppedString(); return *this; }
         
         // Pass on some std::string functions to sFull
         /// insert text
@@ -240,15 +317,17 @@ namespace TFW {
         
         /// Get current defined width
         size_t GetWidth () const { return width; }
-        /// Set a new width
-        void SetWidth (size_t _w) { width = _w; UpdateCroppedString(); }
+        /// Set a new width, re-crops only if the width actually changes
+        void SetWidth (size_t _w) { if (_w != width) { width = _w; UpdateCroppedString(); } }
         /// Get current defined starting position
         size_t GetStartPos () const { return startPos; }
         /// Set a new starting position, which can be, at maximum, the last character
         void SetStartPos (size_t _sp) { startPos = std::min(_sp,size()-1); UpdateCroppedString(); }
         
         /// How many characters missing to the right of the cropped string?
-        size_t GetNumCharsCropped () const { return sFull.size() - startPos - sCropped.size(); }
+        size_t GetNumCharsCropped () const { return sFull.size() - startPos - cropped().size(); }
+        /// Is there no cropping at all, so that the cropped string is the full string?
+        bool IsUncropped () const { return width == UINT64_MAX && startPos == 0; }
 
         /// Recalculate `sCropped` from `sFull`
         void UpdateCroppedString ();
@@ -267,6 +346,7 @@ namespace TFW {
         unsigned    widgetId = 0;       ///< unique id assigned by main window
         bool        bVisible = true;    ///< currently visible?
         bool        bEnabled = true;    ///< enabled / disabled
+        bool        bDirty = true;      ///< needs to be drawn anew? See IsDirty()
         CroppedString caption;          ///< the text to display
         float       colBk[4];           ///< background color
         float       colFg[4];           ///< foreground color
@@ -291,15 +371,25 @@ namespace TFW {
         virtual bool operator == (const Widget& o) const { return widgetId && widgetId == o.widgetId; }
         
         /// show/hide the widget
-        virtual void SetVisible (bool _bVisible = true) { bVisible = _bVisible; }
+        virtual void SetVisible (bool _bVisible = true) { bVisible = _bVisible; SetDirty(); }
         /// Is the widget visible?
         virtual bool IsVisible () const { return bVisible; }
         
         /// enabled/dsiable the widget
-        virtual void SetEnabled (bool _bEnabled = true) { bEnabled = _bEnabled; }
+        virtual void SetEnabled (bool _bEnabled = true) { bEnabled = _bEnabled; SetDirty(); }
         /// Is the widget enabled=
         bool IsEnabled () const { return bEnabled; }
         
+        /// @brief Mark the widget to be drawn anew, also reports its area to the main window as damaged
+        /// @details Setters call this automatically. Derived widgets call it
+        ///          when changing what they draw by other means.
+        virtual void SetDirty (bool _bDirty = true);
+        /// Does the widget need to be drawn anew, i.e. does its last drawing no longer reflect its state?
+        virtual bool IsDirty () const { return bDirty || NeedsImmediateRedraw(); }
+        /// @brief Is the widget changing by itself in reaction to the user, like a blinking caret?
+        /// @details Such changes are drawn in the next frame, regardless of MainWnd::SetMaxRefreshRate()
+        virtual bool NeedsImmediateRedraw () const { return false; }
+        
         /// Does the widget have focus?
         inline bool HasFocus () const;
         
@@ -307,7 +397,10 @@ namespace TFW {
         inline bool IsMainWnd () const;
         
         /// Set the text to display
-        virtual void SetCaption (const std::string& _c) { caption = _c; }
+        virtual void SetCaption (const std::string& _c) { caption = _c; SetDirty(); }
+        /// @brief Set the text to display, taking over the string's buffer
+        /// @note Derived classes overriding SetCaption() need to override both overloads
+        virtual void SetCaption (std::string&& _c) { caption = std::move(_c); SetDirty(); }
         /// Get current text
         const std::string& GetCaption () const { return caption.full(); }
         /// No caption defined?
@@ -320,21 +413,22 @@ namespace TFW {
 
         /// sets the background color
         virtual void SetBkColor (const float _col[4])
-        { std::memmove (colBk, _col, sizeof(colBk)); }
+        { std::memmove (colBk, _col, sizeof(colBk)); SetDirty(); }
         /// sets the background color to some standard XP color
         virtual void SetBkColor (XPStdColorsE _colId)
         { SetBkColor (COL_TRANSPARENT); colBk[0] = (float)_colId; }
         /// sets the foreground color for enabled and disabled case
         virtual void SetFgColor (const float _col[4], const float _colDisabled[4])
         {   std::memmove (colFg, _col, sizeof(colFg));
-            std::memmove (colFgDisabled, _colDisabled, sizeof(colFgDisabled)); }
+            std::memmove (colFgDisabled, _colDisabled, sizeof(colFgDisabled)); SetDirty(); }
         /// sets the foreground color to some standard XP color
         virtual void SetFgColor (XPStdColorsE _colId, XPStdColorsE _colIdDisabled)
         {   SetFgColor (COL_TRANSPARENT, COL_TRANSPARENT);
             colFg[0] = (float)_colId; colFgDisabled[0] = (float)_colIdDisabled; }
 
         /// set geometry of widget, updates visible part of caption
-        virtual void SetGeometry (const Rect& _r) { Rect::SetGeometry(_r); caption.SetWidth((size_t)_r.Width()); }
+        virtual void SetGeometry (const Rect& _r)
+        { SetDirty(); Rect::SetGeometry(_r); caption.SetWidth((size_t)_r.Width()); SetDirty(); }
 
     protected:
         /// Called by MainWnd, this function does the drawing
@@ -570,6 +664,7 @@ namespace TFW {
         bool            bPwdMode = false;       ///< if `true` displays asterisks only
     protected:
         size_t          caretPos = 0;           ///< where is the caret, i.e. the current insert position?
+        bool            bCaretDrawn = false;    ///< was the caret shown when last drawn?
         std::string     prevTxt;                ///< last text informed to main window, compare-bases for "has changed?"
     public:
         /// construct an edit field, for positioning params see struct WidgetAddTy
@@ -602,7 +697,12 @@ namespace TFW {
         /// Paste text from clipboard/pasteboard at current caret position
         virtual void ClipPaste ();
         
+        /// The blinking caret needs to appear or disappear
+        virtual bool NeedsImmediateRedraw () const { return IsCaretShown() != bCaretDrawn; }
+        
     protected:
+        /// Is the blinking caret to be shown in the current frame?
+        bool IsCaretShown () const;
         /// Entry into the fields
         virtual void DoHandleKey (char /*inKey*/, XPLMKeyFlags /*inFlags*/, unsigned char /*inVirtualKey*/);
         /// Places the caret
@@ -630,6 +730,11 @@ namespace TFW {
         int             iVal = 0;       ///< the last integer or boolean (Checkbox) value stored
         double          dVal = 0.0;     ///< the last double value stored
         bool            bEnabled = true;///< relevant for checkboxes: enabled or disabled?
+        CollationTy     keyColl = COLL_BINARY;  ///< collation `sKey` has been computed for, `COLL_BINARY` if there is no key
+        std::string     sKey;           ///< collation key of `sVal`, computed once after the value is set, compared when sorting
+        int             measWidth = -1; ///< text width, with which this value is accounted for in its column's width histogram, -1 if not accounted for
+        uint8_t         style = 0;      ///< style index as per the column's formatting rules, 0 is the standard style
+        uint8_t         rowStyle = 0;   ///< style index this value imposes on its entire row as per the column's formatting rules
     public:
         /// Text color to use, defaults to "use standard text color"
         float           col[4] = { NAN, NAN, NAN, 0.00f};
@@ -637,7 +742,7 @@ namespace TFW {
         ListItem() {}
         ListItem(const char* _s) : sVal(_s) {}
         ListItem(const std::string& _s) : sVal(_s) {}
-        ListItem(std::string&& _s) : sVal(_s) {}
+        ListItem(std::string&& _s) : sVal(std::move(_s)) {}
         ListItem(int _i) : sVal(std::to_string(_i)), iVal(_i) {}
         ListItem(bool _b) : sVal(_b ? "X" : " "), iVal(_b) {}
         ListItem(double _d, int _prec = 2) : dVal(_d) { Set(_d,_prec); }
@@ -656,19 +761,21 @@ namespace TFW {
         bool operator != (int _i) const { return iVal != _i; }
 
         /// Sets current value to a string value
-        void Set (const char* _s) { sVal = _s; }
+        void Set (const char* _s) { sVal = _s; keyColl = COLL_BINARY; }
         /// Sets current value to a string value
-        void Set (const std::string& _s) { sVal = _s; }
+        void Set (const std::string& _s) { sVal = _s; keyColl = COLL_BINARY; }
         /// Sets current value to a string value
-        void Set (std::string&& _s) { sVal = _s; }
+        void Set (std::string&& _s) { sVal = std::move(_s); keyColl = COLL_BINARY; }
         /// Sets current value to an integer value
-        void Set (int _i) { sVal = std::to_string(iVal=_i); }
+        void Set (int _i) { sVal = std::to_string(iVal=_i); keyColl = COLL_BINARY; }
         /// Sets current value to a boolean value
-        void Set (bool _b) { sVal = (iVal=_b) ? "X" : " "; }
+        void Set (bool _b) { sVal = (iVal=_b) ? "X" : " "; keyColl = COLL_BINARY; }
         /// @brief Sets current value to a double value
         /// @param _d The value
         /// @param _prec Precision, with with the value is to be displayed
         void Set (double _d, int _prec = 2);
+        /// Reset to an empty value with standard properties, keeping the string storage for reuse
+        void Clear ();
         
         const std::string& GetS () const { return sVal.full(); }    ///< get current string representation
         int                GetI () const { return iVal; }           ///< get last set integer value
@@ -679,10 +786,21 @@ namespace TFW {
         char* GetCroppedS () const { return (char*)sVal.cropped_str(); }
         /// Sets the columns width
         void SetWidth (size_t _w) { sVal.SetWidth(_w); }
+        /// Width the value is currently cropped to
+        size_t GetWidth () const { return sVal.GetWidth(); }
+        /// Style index as per the column's formatting rules, 0 is the standard style
+        uint8_t GetStyle () const { return style; }
         
         /// Define text color
         void SetColor (const float _c[4]) { memmove(col, _c, sizeof(col)); }
         
+        /// @brief Makes sure the collation key for `_coll` is available
+        /// @details The key is computed only if not yet available for `_coll`,
+        ///          i.e. once after each change of the value.
+        void UpdateKey (CollationTy _coll);
+        /// Current collation key, empty if none computed
+        const std::string& GetKey () const { return sKey; }
+
         /// Set checkbox enabled or disabled
         void SetEnable (bool _b) { bEnabled = _b; }
         /// Is checkbox enabled?
@@ -694,6 +812,9 @@ namespace TFW {
         /// @param _dataType Data type to use for comparison
         /// @param _thisBeforeOnEqual For creating a unique order even in case this column contains duplicates this parameter defines if this < o if column value is equal
         bool less (const ListItem& o, DataTypeTy _dataType, bool _thisBeforeOnEqual) const;
+        
+        friend class ListBox;
+        friend struct ListMemStatsTy;
     };
     
     /// Represents an actual row in a list box, primarily a vector of ListItem objects
@@ -701,16 +822,52 @@ namespace TFW {
     {
     protected:
         unsigned sequNr = 0;            ///< order, in which rows had been added, sorting order of "unsorted" data
+        unsigned slot = 0;              ///< stable index into the list box's selection bitset, assigned when added, kept when sorted
+        unsigned level = 0;             ///< nesting level in a TreeListBox, 0 for top-level rows
+        uint8_t style = 0;              ///< style index of the entire row, as imposed by any of its values, see ListFormatRule::bRow
     public:
         void* refCon = nullptr;         ///< user-defined refCon tied to this row, uniquely identifies the data
+        unsigned height = 0;            ///< row height in boxels, 0 means the list box's standard line height; once added change it via ListBox::SetRowHeight()
     public:
         /// @brief Constructor creates a row
         /// @param _refCon Application-defined refCon, unique for this row
         /// @param _fields A list of field values / elements in the row
         ListRow (void* _refCon,
                  std::initializer_list<ListItem> _fields = {});
+        /// @brief Constructor creates a row, taking over the field values without copying
+        /// @param _refCon Application-defined refCon, unique for this row
+        /// @param _fields Field values / elements in the row, moved into the row
+        ListRow (void* _refCon,
+                 std::vector<ListItem>&& _fields);
         /// Get row's sequence number
         unsigned GetSequNr () const { return sequNr; }
+        
+        /// @brief Set the value of column `_col`, reusing the existing value's storage
+        /// @details Extends the row if needed. Accepts any value ListItem::Set() accepts.
+        template<class T>
+        ListRow& Set (unsigned _col, T&& _v)
+        {
+            if (_col >= size()) resize(_col+1);
+            (*this)[_col].Set(std::forward<T>(_v));
+            return *this;
+        }
+        /// @brief Set the values of columns 0, 1, 2... in place, reusing existing storage
+        /// @details Together with ListBox::ObtainRow() this builds rows without allocating:
+        ///          `lb.AddRow(std::move(lb.ObtainRow(refCon).Assign("EDDF", 42, 3.5)));`
+        template<class... Args>
+        ListRow& Assign (Args&&... _vals)
+        {
+            // grow at most once, and to the exact size only
+            if (capacity() < sizeof...(Args))
+                reserve(sizeof...(Args));
+            unsigned col = 0;
+            (Set(col++, std::forward<Args>(_vals)), ...);
+            return *this;
+        }
+        /// Get row's nesting level in a TreeListBox, 0 for top-level rows
+        unsigned GetLevel () const { return level; }
+        /// Style index of the entire row as per formatting rules, 0 is the standard style
+        uint8_t GetStyle () const { return style; }
 
         /// equality is defined via `refCon`. So for identifying the row it should be set uniquely
         bool operator == (const ListRow& o) const { return refCon == o.refCon; }
@@ -727,11 +884,69 @@ namespace TFW {
         void SetSequNr (unsigned _s) { sequNr = _s; }
         
         friend class ListBox;
+        friend class TreeListBox;
     };
     
     /// Type of vector to use for storing rows
     typedef std::vector<ListRow> ListRowVecTy;
     
+    /// @brief Prefix sums over a sequence of values (Fenwick tree)
+    /// @details Updating a value, appending a value, computing a prefix sum,
+    ///          and finding the element containing a given sum all are `O(log n)`.
+    class PrefixSumTree
+    {
+    protected:
+        std::vector<int> tree;          ///< 1-based Fenwick tree, `tree[i]` holds the sum of values `(i - lowbit(i), i]`, `tree[0]` unused
+    public:
+        /// Remove all values
+        void clear () { tree.clear(); }
+        /// Number of values
+        size_t size () const { return tree.empty() ? 0 : tree.size() - 1; }
+        /// Rebuild from the given values in `O(n)`
+        void assign (const std::vector<int>& _vals);
+        /// Append a value
+        void push_back (int _v);
+        /// Add `_delta` to the value at index `_i`
+        void add (size_t _i, int _delta);
+        /// Sum of the first `_n` values
+        int prefix (size_t _n) const;
+        /// Sum of all values
+        int total () const { return prefix(size()); }
+        /// Index of the value, within which the running sum reaches beyond `_sum`, `size()` if `_sum >= total()`
+        size_t find (int _sum) const;
+    };
+    
+    /// A text style for list box values, referred to by its index, see ListBox::AddStyle()
+    struct ListStyleTy {
+        float col[4] = { NAN, NAN, NAN, 0.00f}; ///< text color, defaults to "use standard text color"
+        bool bBold = false;                     ///< draw bold text?
+    };
+    
+    /// @brief Formatting rule of a list box column, maps a condition on a value to a style
+    /// @details Rules are evaluated only when a value is set via the list box,
+    ///          the resulting style index is stored with the value.
+    struct ListFormatRule {
+        FormatCondTy cond = FMT_LESS;   ///< condition
+        double val = 0.0;               ///< threshold, or lower bound of a range
+        double valTo = 0.0;             ///< upper bound of a range (excluding)
+        std::string sVal;               ///< string to compare with in string columns
+        uint8_t style = 0;              ///< style to apply if the condition is met, see ListBox::AddStyle()
+        bool bRow = false;              ///< apply the style to the entire row instead of just this value?
+        
+        /// Rule comparing with a threshold
+        ListFormatRule (FormatCondTy _cond, double _val, uint8_t _style, bool _bRow = false) :
+        cond(_cond), val(_val), style(_style), bRow(_bRow) {}
+        /// Rule testing for a range `[_from, _to)`
+        ListFormatRule (double _from, double _to, uint8_t _style, bool _bRow = false) :
+        cond(FMT_RANGE), val(_from), valTo(_to), style(_style), bRow(_bRow) {}
+        /// Rule comparing a string column's values with a string
+        ListFormatRule (FormatCondTy _cond, const std::string& _s, uint8_t _style, bool _bRow = false) :
+        cond(_cond), sVal(_s), style(_style), bRow(_bRow) {}
+        
+        /// Does the value meet the condition?
+        bool Matches (const ListItem& item, DataTypeTy _dataType) const;
+    };
+    
     /// Defines what a list box column looks like
     class ListColumnDef
     {
@@ -740,23 +955,67 @@ namespace TFW {
         int width = 50;                     ///< column width in boxels
         DataTypeTy dataType = DTY_STRING;   ///< type of data, primarily importand for sorting
         bool bVisible = true;               ///< column currently shown?
+        CollationTy collation = COLL_BINARY;///< ordering rules for sorting a string column
+        size_t cropWidth = 0;               ///< width values of this column need to be cropped to, maintained by the list box, values are cropped lazily when drawn
+        bool bAutoWidth = false;            ///< column width follows the widest value (and the header), see ListBox::SetColAutoWidth()
+        bool bWidthHist = false;            ///< is `widthHist` available? Built upon first need, then maintained by the list box
+        std::map<int,unsigned> widthHist;   ///< histogram of values' text widths: how many values have which width, the last element is the widest
+        AggregateTy aggregate = AGG_NONE;   ///< aggregate to show in the footer row, for `DTY_INT` and `DTY_DOUBLE` columns only, see ListBox::SetColAggregate()
+        bool bAggStats = false;             ///< are `aggVals` and `aggSum` available? Built upon first need, then maintained by the list box, see AggAdd()
+        std::multiset<double> aggVals;      ///< all finite numeric values of the column, ordered, so that the first is the minimum and the last the maximum
+        double aggSum = 0.0;                ///< sum of all values in `aggVals`, see GetAggSum()
+        double aggComp = 0.0;               ///< compensation for the rounding errors of `aggSum` (Neumaier summation)
+        std::vector<ListFormatRule> fmtRules;   ///< formatting rules, the first matching value rule and the first matching row rule apply, see ListBox::AddFormatRule()
     public:
         /// Standard constructor creates a non-existing column
         ListColumnDef () : width(0), dataType(DTY_NULL), bVisible(false) {}
-        /// Constructor defines a column with name, width, type, and visibility
-        ListColumnDef (const std::string& _name,
+        /// Constructor defines a column with name, width, type, visibility, and collation
+        ListColumnDef (std::string _name,
                        int _w,
                        DataTypeTy _dt = DTY_STRING,
-                       bool _v = true) :
-        name(_name), width(_w), dataType(_dt), bVisible(_v) {}
+                       bool _v = true,
+                       CollationTy _coll = COLL_BINARY) :
+        name(std::move(_name)), width(_w), dataType(_dt), bVisible(_v), collation(_coll) {}
         
         /// return cropped name as char pointer
         char* GetCroppedName () const { return (char*)name.cropped_str(); }
+        
+        /// Add a value to the aggregate statistics, non-finite values don't count
+        void AggAdd (double _v);
+        /// Remove a value from the aggregate statistics, `false` if it wasn't there
+        bool AggRemove (double _v);
+        /// Forget the aggregate statistics, so that they are collected anew when needed
+        void AggReset ();
+        /// Sum of all values, compensated for rounding errors
+        double GetAggSum () const { return aggSum + aggComp; }
     };
     
     /// Type of vector to use for storing column definitions
     typedef std::vector<ListColumnDef> ListColDefVecTy;
     
+    /// @brief Memory held by a list box's rows and values, see ListBox::GetMemStats()
+    /// @details Counts the list's own heap blocks and how much of them holds data.
+    ///          How fragmented the process heap is can't be told from here.
+    struct ListMemStatsTy
+    {
+        size_t numRows = 0;             ///< number of rows in the list
+        size_t numPooledRows = 0;       ///< number of retired rows kept for reuse
+        size_t numHeapBlocks = 0;       ///< number of separate heap allocations held
+        size_t bytesUsed = 0;           ///< bytes actually holding row data
+        size_t bytesReserved = 0;       ///< bytes allocated on the heap
+        
+        /// Share of the reserved memory not holding data, `0.0` if nothing is reserved
+        double GetSlack () const
+        { return bytesReserved ? 1.0 - double(bytesUsed) / double(bytesReserved) : 0.0; }
+        
+        /// Account for a string, which is in use or only keeps its storage
+        void Add (const std::string& _s, bool _bInUse);
+        /// Account for a croppable string, which is in use or only keeps its storage
+        void Add (const CroppedString& _s, bool _bInUse);
+        /// Account for a row and its values, which is in use or only keeps its storage
+        void Add (const ListRow& _row, bool _bInUse);
+    };
+    
     /// @brief List box
     ///
     /// Idea:
@@ -776,24 +1035,72 @@ namespace TFW {
     {
     protected:
         ListColDefVecTy cols;               ///< column definitions
+        std::vector<unsigned> colOrder;     ///< ids of all columns in display order, permuted when the user moves columns
+        // cached column geometry, rebuilt only when column definitions change:
+        std::vector<unsigned> colVis;       ///< ids of visible columns in display order
+        std::vector<int> colRight;          ///< prefix sums of `colVis`' widths, i.e. right edge of each visible column relative to the first one
+        bool bColGeoDirty = true;           ///< column geometry needs to be rebuilt
+        size_t colFrozen = 0;               ///< number of leading visible columns, which stay in place when scrolling horizontally
+        size_t colFirst = 0;                ///< horizontal scroll position: index into `colVis` of first scrolling column to show, never less than the number of frozen columns
+        size_t colDrawEnd = 0;              ///< index into `colVis` after the last column to draw, updated in DoDraw()
         // sorting definitions:
         unsigned  sortedBy = 0;             ///< column, by which we sort the data
         SortingTy sorted = SORT_UNSORTED;   ///< list sorted by any column?
         
         ListRowVecTy rows;                  ///< rows, actual data to be displayed
+        ListRowVecTy rowPool;               ///< retired rows (overwritten or removed), whose storage ObtainRow() reuses
+        size_t rowPoolMax = 0;              ///< maximum number of rows kept in `rowPool`, see SetRowPoolLimit()
         unsigned sequRow = 0;               ///< last sequence number assinged to a row
         
         unsigned lnHeightFactor = 200;      ///< line height in % of font height, defaults to 150%
-        unsigned lnHeight = 15;             ///< current aboslute line height
+        unsigned lnHeight = 15;             ///< current aboslute line height, standard height of a row
+        bool bFooter = false;               ///< show a footer row with column aggregates?
+        std::vector<ListStyleTy> styles = { ListStyleTy() };    ///< text styles referred to by formatting rules, index 0 is the standard style
+        mutable PrefixSumTree rowTops;      ///< prefix sums of row heights in display order, i.e. each row's top, see GetRowTops()
+        mutable bool bRowTopsDirty = true;  ///< `rowTops` needs to be rebuilt after rows got sorted or removed
 
-        void* selRefCon = nullptr;          ///< `refCon` of the selected line if any
-        
-        unsigned rowFirst = 0;              ///< scroll position: this is the first row to show
-        unsigned rowMax = 0;                ///< how many rows can be shown with current list box size?
-        unsigned rowFirstMaxDown = 0;       ///< what would be the first row to show when fully scrolled down?
+        void* selRefCon = nullptr;          ///< `refCon` of the current row (last clicked or navigated to) if any
+        void* selAnchor = nullptr;          ///< `refCon` of the row a range selection starts at
+        bool bMultiSel = false;             ///< can multiple rows be selected?
+        std::vector<uint64_t> selBits;      ///< selection bitset, indexed by `ListRow::slot`
+        size_t selCount = 0;                ///< number of selected rows
+        std::vector<void*> slotRefCon;      ///< `refCon` of the row occupying each slot, `nullptr` if unused
+        std::vector<unsigned> freeSlots;    ///< slots of removed rows, reused by rows added later
+        
+        int scrollY = 0;                    ///< vertical scroll position in boxels: how far the rows are moved up
+        unsigned rowFirst = 0;              ///< first row (partly) shown, derived from `scrollY`
+        unsigned rowMax = 0;                ///< how many rows can be shown entirely with current list box size?
+        float scrollVel = 0.0f;             ///< scrolling velocity in boxels per second, decays over time (inertia)
+        float scrollRemain = 0.0f;          ///< fraction of a boxel scrolled by inertia, but not yet applied
+        std::chrono::steady_clock::time_point scrollLast; ///< when inertia was applied last
         
         int sbThumbTop = 0;                 ///< if there is a scrollbar then this is the thumb's top position
         int sbThumbBottom = 0;              ///< if there is a scrollbar then this is the thumb's bottom position
+        bool bThumbDrag = false;            ///< is the scrollbar thumb being dragged?
+        int thumbDragOfs = 0;               ///< while dragging: distance from the mouse down to the thumb's top
+        
+        /// Mouse operations in the column header
+        enum ColDragTy {
+            COLDRAG_NONE = 0,               ///< no mouse operation in the header
+            COLDRAG_CLICK,                  ///< mouse down on a header, might become a click (sorting) or a move
+            COLDRAG_RESIZE,                 ///< resizing a column by dragging its right border
+            COLDRAG_MOVE,                   ///< moving a column by dragging its header
+        };
+        ColDragTy colDrag = COLDRAG_NONE;   ///< current mouse operation in the header
+        unsigned colDragId = 0;             ///< column being clicked, resized, or moved
+        int colDragX = 0;                   ///< x position where the mouse operation started
+        int colDragWidth = 0;               ///< column width when the resize operation started
+        size_t colDropIdx = 0;              ///< while moving a column: index into `colVis` the column would be inserted before
+        bool bCursorResize = false;         ///< draw a resize cursor in the next drawing cycle?
+        bool bCursorDrawn = false;          ///< is a resize cursor part of the last drawing?
+        Point cursorPos;                    ///< position of the resize cursor
+        
+        // type-ahead search:
+        std::string typePrefix;             ///< characters typed so far
+        std::chrono::steady_clock::time_point typeLast; ///< when the last character was typed, after a timeout `typePrefix` starts over
+        std::vector<std::pair<std::string,size_t>> typeIdx; ///< if the list is not sorted by the search column: case-folded values with their row index, sorted, built upon first search
+        unsigned typeIdxCol = 0;            ///< column `typeIdx` has been built for
+        bool bTypeIdxDirty = true;          ///< rows changed, `typeIdx` needs to be rebuilt
 
     public:
         /// @brief construct a listbox, for positioning params see struct WidgetAddTy
@@ -810,8 +1117,69 @@ namespace TFW {
         /// @param colId Column id this definition refers to
         /// @param def Column definition
         virtual void AddCol (unsigned colId, ListColumnDef&& def);
+        /// @brief Get a column by id
+        /// @note As the column definition could be changed via the returned reference
+        ///       the column geometry gets recalculated before next drawing.
+        ///       With SetRenderCache() call SetColChanged() to have the change drawn right away.
+        virtual ListColumnDef& GetCol (unsigned colId) { bColGeoDirty = true; return cols.at(colId); }
         /// Get a column by id
-        virtual ListColumnDef& GetCol (unsigned colId) { return cols.at(colId); }
+        virtual const ListColumnDef& GetCol (unsigned colId) const { return cols.at(colId); }
+        /// @brief Announce that a column definition was changed via GetCol()
+        /// @return `false` if there is no column with that `colId`
+        virtual bool SetColChanged (unsigned colId);
+        /// Set a column's width
+        virtual void SetColWidth (unsigned colId, int _w);
+        /// @brief Let a column's width follow its widest value
+        /// @details The list box keeps a histogram of all values' text widths
+        ///          up-to-date when rows are added, changed, or removed,
+        ///          so that the widest value is known without measuring all rows again.
+        ///          Resizing the column via SetColWidth() ends auto width.
+        virtual void SetColAutoWidth (unsigned colId, bool _bAuto = true);
+        /// Show/hide a column
+        virtual void SetColVisible (unsigned colId, bool _bVisible);
+        /// @brief Scroll horizontally so that the given visible column is the first shown
+        /// @param _visIdx Index of the column among the visible columns, 0 is the left-most visible column
+        virtual void SetFirstCol (size_t _visIdx);
+        /// Index of the first shown column among the visible columns, not counting frozen columns
+        size_t GetFirstCol () const { return colFirst; }
+        /// @brief Freeze leading columns, so that they stay in place when scrolling horizontally
+        /// @param _n Number of visible columns, in display order, which don't scroll
+        virtual void SetFrozenCols (size_t _n);
+        /// Scrolling by inertia, or the resize cursor needs to disappear
+        virtual bool NeedsImmediateRedraw () const
+        { return std::abs(scrollVel) > 0.0f || (bCursorDrawn && !bCursorResize); }
+        /// Number of frozen leading columns
+        size_t GetFrozenCols () const { return colFrozen; }
+        /// @brief Move a column to another display position
+        /// @param colId Column id of the column to move
+        /// @param _visIdx Index among the visible columns, before which the column shall be shown, the number of visible columns means "at the end"
+        virtual void MoveCol (unsigned colId, size_t _visIdx);
+        /// Column ids in display order
+        const std::vector<unsigned>& GetColOrder () const { return colOrder; }
+        /// @brief Define the aggregate a numeric column shows in the footer row
+        /// @see SetFooter()
+        virtual void SetColAggregate (unsigned colId, AggregateTy _agg);
+        /// @brief Get an aggregate of a numeric column's values, need not be the one shown in the footer
+        /// @details The list box keeps all values of the column in an ordered multiset
+        ///          and their sum up-to-date when rows are added, changed, or removed,
+        ///          so that none of the aggregates requires to scan the rows again.
+        /// @return `false` if the column is not numeric, or if there are no values to compute min/max/mean of
+        virtual bool GetColAggregate (unsigned colId, AggregateTy _agg, double& _val);
+        /// @brief Define a text style to be used by formatting rules
+        /// @return Style index, to be passed to ListFormatRule, 0 if no more styles can be defined
+        virtual uint8_t AddStyle (const float _col[4], bool _bBold = false);
+        /// @brief Add a formatting rule to a column
+        /// @details Rules are evaluated when a value is set via AddRow() or SetItem(),
+        ///          the style is stored with the value. Drawing just looks up the style.
+        ///          Existing values are re-evaluated once here.
+        ///          A color set via ListItem::SetColor() takes precedence.
+        virtual void AddFormatRule (unsigned colId, ListFormatRule&& rule);
+        /// Remove all formatting rules of a column
+        virtual void ClearFormatRules (unsigned colId);
+        /// Show/hide the footer row with the columns' aggregates
+        virtual void SetFooter (bool _b);
+        /// Is the footer row shown?
+        bool HasFooter () const { return bFooter; }
         
         /// @brief Define sorting, will immediately resort the available data
         /// @param _col Column id by which the data is to be sorted
@@ -821,8 +1189,13 @@ namespace TFW {
         /// @brief set geometry of list box
         virtual void SetGeometry (const Rect& _r);
 
+        /// Scroll vertically to a position in boxels, stops any scrolling inertia
+        virtual void SetScrollPos (int _y);
+        /// Current vertical scroll position in boxels
+        int GetScrollPos () const { return scrollY; }
+        
         /// Set line height
-        virtual void SetLnHeightFactor (unsigned _lhf) { lnHeightFactor = _lhf; }
+        virtual void SetLnHeightFactor (unsigned _lhf) { lnHeightFactor = _lhf; SetDirty(); }
         /// Get current line height factor
         unsigned GetLnHeightFactor () const { return lnHeightFactor; }
         
@@ -833,31 +1206,192 @@ namespace TFW {
         ///       If the same `refCon` is sent in again AddRow()
         ///       overwrites the existing data.
         virtual ListRow& AddRow (ListRow&& row);
-        /// Return row by index (which is unsafe as sorting can change the order)
+        /// @brief Get an empty row to be filled and passed to AddRow()
+        /// @details If enabled by SetRowPoolLimit(), reuses the storage of a row
+        ///          retired by AddRow() (when overwriting), RemoveRow(), or Clear(),
+        ///          so that a refresh cycle of ObtainRow(), ListRow::Assign(),
+        ///          and AddRow() hardly allocates memory.
+        ///          The row has room for a value in each column, so that all of
+        ///          its values live in one block of memory.
+        virtual ListRow ObtainRow (void* _refCon);
+        /// Free the memory of all retired rows kept for reuse
+        virtual void ReleaseRowPool () { rowPool.clear(); rowPool.shrink_to_fit(); }
+        /// @brief Limit the number of retired rows kept for reuse, `0` disables reuse
+        /// @details Rows beyond the limit are freed right away when retired.
+        ///          By default the limit is `0`, so that removed rows free their memory.
+        virtual void SetRowPoolLimit (size_t _max);
+        /// Get the limit of retired rows kept for reuse
+        size_t GetRowPoolLimit () const { return rowPoolMax; }
+        /// @brief Report the memory held by rows and values, including retired rows, and how much of it holds data
+        /// @details Walks all rows and values, so it takes time linear in their number.
+        virtual ListMemStatsTy GetMemStats () const;
+        /// @brief Add/update many rows at once
+        /// @details Like calling AddRow() for each row, but existing rows are looked up
+        ///          via a hash index built once, and the list is sorted only once at the end.
+        virtual void AddRows (ListRowVecTy&& newRows);
+        /// @brief Import rows from a delimited text file, like CSV or TSV
+        /// @details The file is memory-mapped and split into chunks, which are parsed in parallel.
+        ///          Each column's `dataType` defines how its fields are parsed,
+        ///          string columns' collation keys are computed once per distinct value.
+        ///          All rows are then added in one bulk insert, see AddRows().
+        ///          Fields can be enclosed in double quotes to contain the delimiter, but no line breaks.
+        /// @param _path File to read
+        /// @param _delim Field delimiter, e.g. `,` or `\t`
+        /// @param _bHeader Is the first line a header? Then fields are matched to columns by header name if possible
+        /// @param _colIds Column id per field, `UINT_MAX` skips a field; if empty fields go to columns by header name or by position
+        /// @param _refConFn Returns the `refCon` for a parsed row; if empty rows are numbered 1, 2, 3...
+        /// @return Number of rows imported, 0 if the file could not be read
+        virtual size_t ImportDelimited (const std::string& _path,
+                                        char _delim = ',',
+                                        bool _bHeader = true,
+                                        std::vector<unsigned> _colIds = {},
+                                        std::function<void*(const ListRow&)> _refConFn = nullptr);
+        /// @brief Change a single value of a row
+        /// @details Preferred over changing the value via the row reference
+        ///          as it also maintains sorting and auto width of the column.
+        /// @return `false` if there is no row with that `_refCon`
+        virtual bool SetItem (void* _refCon, unsigned colId, ListItem&& item);
+        /// @brief Return row by index (which is unsafe as sorting can change the order)
+        /// @note After changing the row via the returned pointer call SetRowChanged().
         virtual ListRow* GetRow (size_t index);
         /// Return row by index (which is unsafe as sorting can change the order)
         virtual const ListRow* GetRow (size_t index) const;
         /// Number of entries in the list
         virtual size_t GetSize() const { return rows.size(); }
+        /// @brief Change a row's height
+        /// @param _refCon Row to change
+        /// @param _h New height in boxels, 0 for the standard line height
+        /// @return `false` if there is no row with that `_refCon`
+        virtual bool SetRowHeight (void* _refCon, unsigned _h);
         /// Remove a row, identified by ListRow::refCon
         virtual bool RemoveRow (void* _refCon);
-        /// Clear a list: Remove all rows
+        /// @brief Clear a list: Remove all rows
+        /// @details Takes time linear in the number of rows. Rows up to the limit
+        ///          set by SetRowPoolLimit() keep their storage for reuse, the others are freed.
         virtual void Clear ();
         
-        /// Set selection, returns true if the row is available
-        virtual bool SelectRow (void* _refCon);
+        /// @brief Set selection, returns true if the row is available
+        /// @param _refCon Row to select, becomes the current row
+        /// @param _bAdd Add to the current selection (in multi-selection lists) instead of replacing it
+        virtual bool SelectRow (void* _refCon, bool _bAdd = false);
+        /// @brief Allow selection of multiple rows
+        /// @details Ctrl-click toggles a row, shift-click and shift plus cursor keys select a range, ctrl-A selects all rows.
+        ///          Note that X-Plane passes no modifier keys with mouse clicks, see GetModifierKeys().
+        void SetMultiSelect (bool _b) { bMultiSel = _b; }
+        /// Can multiple rows be selected?
+        bool IsMultiSelect () const { return bMultiSel; }
+        /// Is the row selected?
+        bool IsSelected (const ListRow& row) const
+        { return row.slot/64 < selBits.size() && (selBits[row.slot/64] >> (row.slot%64)) & 1; }
+        /// Select all rows (multi-selection lists only)
+        virtual void SelectAll ();
+        /// Clear selection
+        virtual void SelectNone ();
+        /// Number of selected rows
+        size_t GetSelectedCount () const { return selCount; }
+        /// @brief `refCon`s of all selected rows
+        /// @note Returned in the order of internal slots, not in display order.
+        ///       Visits only set bits, i.e. `O(selected)` plus one test per 64 rows.
+        std::vector<void*> GetSelectedRefCons () const;
+        /// Remove all selected rows, returns the number of rows removed
+        virtual size_t RemoveSelected ();
         /// find a row by refCon
         virtual const ListRow* FindRow (void* _refCon) const;
-        /// find a row by refCon
+        /// @brief find a row by refCon
+        /// @note After changing the row via the returned pointer call SetRowChanged().
         virtual ListRow* FindRow (void* _refCon);
-        /// Return selected row or NULL if none is selected / available
+        /// @brief Announce that a row was changed via GetRow() or FindRow(), so that it gets drawn anew
+        /// @details Updates auto-width columns, formatting, and collation keys right away,
+        ///          footer aggregates are collected anew when next needed.
+        ///          Does not re-sort the list, use SetItem() for that.
+        /// @return `false` if there is no row with that `_refCon`
+        virtual bool SetRowChanged (void* _refCon);
+        /// Return current selected row or NULL if none is selected / available, see GetSelectedRefCons() for all selected rows
         virtual const ListRow* GetSelectedRow () const { return FindRow (selRefCon); }
+        /// @brief Save column definitions, rows, and sorting state to a binary snapshot file
+        /// @details Values are stored in typed per-column arrays, strings are interned.
+        ///          `refCon`s are stored as plain integers, so a snapshot is only meaningful
+        ///          if they are ids rather than pointers. Styles and formatting rules are not saved,
+        ///          they are defined by code. The file uses native byte order.
+        /// @return Success?
+        virtual bool SaveSnapshot (const std::string& _path) const;
+        /// @brief Replace columns and rows by a snapshot saved with SaveSnapshot()
+        /// @details The file is memory-mapped, numbers are taken directly from the typed arrays
+        ///          and strings from the interned string table, nothing is parsed.
+        /// @return `false` if the file could not be read or is no valid snapshot, the list is unchanged then
+        virtual bool LoadSnapshot (const std::string& _path);
+        /// @brief Select the first row, whose value in the search column starts with `_prefix`, ignoring case
+        /// @details The search column is the sorting column if it holds strings,
+        ///          otherwise the first visible string column.
+        ///          This is what type-ahead uses.
+        /// @return Found and selected a row?
+        virtual bool SelectByPrefix (const std::string& _prefix);
 
         
     protected:
         /// @brief Crops texts of header and content to match geometry
         virtual void DoCropTexts ();
         
+        /// @brief Rebuilds cached column geometry (visible columns and their offsets) if needed
+        virtual void UpdateColGeometry ();
+        /// Left edge of visible column `_visIdx`, relative to the first visible column
+        int GetColLeft (size_t _visIdx) const { return _visIdx > 0 ? colRight[_visIdx-1] : 0; }
+        /// Index into `colVis` after the last frozen column, limited to existing columns
+        size_t GetFrozenEnd () const { return std::min(colFrozen, colVis.size()); }
+        /// Width of all frozen columns
+        int GetFrozenWidth () const { return GetColLeft(GetFrozenEnd()); }
+        /// Left edge of visible column `_visIdx` as shown, relative to the left of the list box, considers frozen columns and horizontal scrolling
+        int GetColX (size_t _visIdx) const
+        { return _visIdx <= GetFrozenEnd() ? GetColLeft(_visIdx) :
+                 GetFrozenWidth() + GetColLeft(_visIdx) - GetColLeft(colFirst); }
+        /// First column to draw: the first frozen column if any, otherwise the first scrolling column shown
+        size_t FirstDrawCol () const { return colFrozen > 0 ? 0 : colFirst; }
+        /// Next column to draw, skipping from the last frozen column to the first scrolling column shown
+        size_t NextDrawCol (size_t _visIdx) const { return _visIdx + 1 == GetFrozenEnd() ? colFirst : _visIdx + 1; }
+        /// Width available for columns, which excludes the vertical scrollbar if shown
+        int GetColAreaWidth () const;
+        
+        /// Height available for rows, i.e. below the header and above the footer
+        int GetViewHeight () const { return std::max(Height() - int(lnHeight) * (bFooter ? 2 : 1), 0); }
+        /// Height of a row in boxels
+        int GetRowHeight (const ListRow& row) const { return row.height ? int(row.height) : int(lnHeight); }
+        /// Prefix sums of row heights, rebuilt if needed
+        const PrefixSumTree& GetRowTops () const;
+        /// Top of the row at display position `_idx`, relative to the top of the first row
+        int GetRowTop (size_t _idx) const { return GetRowTops().prefix(_idx); }
+        /// Total height of all rows
+        int GetContentHeight () const { return GetRowTops().total(); }
+        /// Display position of the row at `_y`, relative to the top of the first row, `rows.size()` if below all rows
+        size_t FindRowAt (int _y) const { return GetRowTops().find(_y); }
+        /// Are there more rows than fit, so that a vertical scrollbar is needed?
+        bool HasVertScrollbar () const { return GetContentHeight() > GetViewHeight(); }
+        /// Largest vertical scroll position, at which the last row is at the bottom
+        int GetMaxScrollPos () const { return std::max(GetContentHeight() - GetViewHeight(), 0); }
+        /// Height of the scrollbar thumb, proportional to the visible part of all rows
+        int GetThumbHeight () const;
+        /// @brief Scroll to the position, limited to the valid range
+        /// @return `false` if `_y` had to be limited
+        bool DoScrollTo (int _y);
+        /// Move the list as per the current scrolling velocity and let the velocity decay
+        virtual void DoScrollInertia ();
+        /// Width of the widest value or the header of a column, based on its width histogram
+        virtual int GetColAutoWidth (unsigned colId);
+        /// Indentation of the row's value in the left-most column, in boxels
+        virtual int GetRowIndent (const ListRow&) const { return 0; }
+        
+        /// Account for a value in its column's width histogram and aggregate statistics, if the column keeps them
+        virtual void DoIndexItem (unsigned colId, ListItem& item);
+        /// Remove a value from its column's width histogram and aggregate statistics
+        virtual void DoUnindexItem (unsigned colId, const ListItem& item);
+        /// Evaluate the column's formatting rules for a value, storing the resulting style indexes with the value
+        void DoFormatItem (unsigned colId, ListItem& item);
+        /// Determine the row's style from its values' row styles
+        void DoUpdateRowStyle (ListRow& row);
+        /// Account for all values of a row in the width histograms and aggregate statistics, and evaluate formatting rules
+        void DoIndexRow (ListRow& row);
+        /// Remove all values of a row from the width histograms and aggregate statistics
+        void DoUnindexRow (const ListRow& row);
+        
         /// @brief Called by MainWnd, this function does the drawing of the list
         /// @param r Drawing rectangle for widget
         virtual void DoDraw (const Rect& r);
@@ -866,12 +1400,17 @@ namespace TFW {
         /// @param rowRect Dimensions of the header row
         /// @param txtColor The color to use for text
         virtual void DoDrawHeader (const Rect& rowRect, const float txtColor[4]);
+        
+        /// @brief Draw the footer row with the columns' aggregates
+        /// @param rowRect Dimensions of the footer row
+        /// @param txtColor The color to use for text
+        virtual void DoDrawFooter (const Rect& rowRect, const float txtColor[4]);
 
         /// @brief Draw a row's content (text)
         /// @param rowRect Dimensions of the row
-        /// @param row The row to draw.
+        /// @param row The row to draw, values are cropped here if their column's width changed
         /// @param txtColor The standard color to use for text (can be overriden in `ListItem.col`)
-        virtual void DoDrawRow (const Rect& rowRect, const ListRow& row, const float txtColor[4]);
+        virtual void DoDrawRow (const Rect& rowRect, ListRow& row, const float txtColor[4]);
         
         /// @brief Draw a list box's vertical scrollbar
         /// @param _r Drawing rectangle for listbox
@@ -883,9 +1422,55 @@ namespace TFW {
         
         /// Re-sort the existing list of rows according to sorting criteria
         virtual void DoSort ();
+        /// Order all rows as per RowLess(), called by DoSort() after collation keys are up-to-date
+        virtual void DoSortRows ();
+        /// Sorting criterion: Shall `r1` be shown before `r2` as per current sorting column and order?
+        bool RowLess (const ListRow& r1, const ListRow& r2) const
+        { return r1.elemLess(r2, sortedBy, sorted, cols[sortedBy].dataType); }
+        /// Compute the collation keys of a row's string values
+        void DoUpdateKeys (ListRow& row);
+        /// Make a row, which is new to the list, known: assign sequence number and slot
+        void DoAdoptRow (ListRow& row);
+        /// Keep a row, which is no longer needed, for reuse by ObtainRow()
+        void RetireRow (ListRow&& row);
+        /// A value parsed by DoParseDelimited(), which ImportDelimited() turns into a ListItem in the main thread
+        struct ImportValTy {
+            std::string s;                      ///< text as in the file
+            std::string key;                    ///< collation key of a string column, which needs one
+            int i = 0;                          ///< value of a DTY_INT or DTY_CHECKBOX column
+            double d = 0.0;                     ///< value of a DTY_DOUBLE column
+            bool bNum = false;                  ///< could the text be parsed into `i` or `d`?
+        };
+        /// The values of one line of a delimited text, indexed by column id
+        typedef std::vector<ImportValTy> ImportRowTy;
+        /// @brief Parse the lines of a delimited text into values, called in parallel by ImportDelimited()
+        /// @details Creates no ListItem, as that might measure text, which only the main thread may do.
+        /// @param _begin Start of the text, beginning of a line
+        /// @param _end End of the text
+        /// @param _delim Field delimiter
+        /// @param _colIds Column id per field, `UINT_MAX` skips a field
+        /// @param[out] _out Parsed lines are appended here
+        void DoParseDelimited (const char* _begin, const char* _end, char _delim,
+                               const std::vector<unsigned>& _colIds,
+                               std::vector<ImportRowTy>& _out) const;
         
         /// define the new selected row and inform the main window
         virtual void DoSelectRow (ListRow& _selRow);
+        /// toggle a row's selection, making it the current row, and inform the main window
+        virtual void DoToggleRow (ListRow& _row);
+        /// @brief select the rows between the two display positions, and inform the main window
+        /// @param _from Position the range starts at (the anchor)
+        /// @param _to Position the range ends at, becomes the current row
+        virtual void DoSelectRange (size_t _from, size_t _to);
+        
+        /// Assign a slot to a new row
+        unsigned AllocSlot (void* _refCon);
+        /// Return a removed row's slot for reuse
+        void FreeSlot (unsigned _slot);
+        /// Select/deselect a slot in the bitset
+        void SetSelBit (unsigned _slot, bool _b);
+        /// Deselect all slots
+        void ClearSelBits ();
         
         /// Find row by refCon
         /// @param[in] _refCon The refCon to search for
@@ -895,21 +1480,145 @@ namespace TFW {
         virtual bool FindRowIdx (void* _refCon, ListRowVecTy::iterator& iter);
         /// Find row by y coordinate, relative to top of list box
         virtual bool FindRowIdx (int _y, ListRowVecTy::iterator& iter);
-        /// Find column by x coordinate, relative to top of list box
+        /// @brief Find column by x coordinate, relative to left of list box
+        /// @details Binary search over the cached column geometry, considers horizontal scrolling
         virtual unsigned FindColIdx (int _x);
+        /// @brief Find a column's right border close to x coordinate, relative to left of list box
+        /// @param _x x coordinate
+        /// @param[out] _visIdx Index into `colVis` of the column, whose right border was found
+        /// @return Found a border?
+        virtual bool FindColBorder (int _x, size_t& _visIdx);
+        /// Find the index into `colVis`, before which a column moved to x would be inserted
+        virtual size_t FindColDropIdx (int _x);
+        /// Column searched by type-ahead: sorting column if it holds strings, otherwise the first visible string column
+        virtual bool GetTypeAheadCol (unsigned& colId);
+        /// @brief Find the first row, whose value in column `colId` starts with `_prefix`, ignoring case
+        /// @details Binary search if the list is sorted by `colId` using a case-folding collation,
+        ///          otherwise searches a separate index of case-folded values.
+        /// @return Iterator to the row found, `rows.end()` if none
+        virtual ListRowVecTy::iterator FindRowByPrefix (unsigned colId, const std::string& _prefix);
 
         /// Ensure that the selected row, if any, is scrolled into visibility
         virtual void MakeSelVisible ();
 
         /// Change selected row upon mouse click
         virtual void DoMouseClick (Point p, MouseBtnTy mouseBtn, XPLMMouseStatus inMouse);
-        /// Handle cursor keys to change selection and scroll list
+        /// Handle mouse in the column header: sort, resize, and move columns
+        virtual void DoMouseClickHeader (Point p, XPLMMouseStatus inMouse);
+        /// Show a resize cursor over column borders
+        virtual XPLMCursorStatus DoHandleCursor (Point p);
+        /// Handle cursor keys to change selection and scroll list, other characters search rows (type-ahead)
         virtual void DoHandleKey (char inKey, XPLMKeyFlags inFlags, unsigned char inVirtualKey);
-        /// Scroll up/down
+        /// Scroll up/down with inertia, or left/right with the horizontal wheel
         virtual void DoMouseWheel (Point p, int wheel, int clicks);
 
     };
     
+    /// @brief List box showing rows in a tree, e.g. rows grouped by a common value
+    ///
+    /// Idea:
+    ///
+    /// - The rows vector of the ListBox holds only the visible rows,
+    ///   in display order, each row directly followed by its visible
+    ///   descendants. ListRow::GetLevel() tells the nesting level.
+    ///
+    /// - Rows are marked as having children via SetHasChildren().
+    ///   The children are requested from the main window via
+    ///   MainWnd::MsgTreeListFetchChildren() only when the row gets expanded
+    ///   the first time.
+    ///
+    /// - Expanding inserts the (flattened) descendants as one block after
+    ///   the parent, collapsing moves that block out of the visible rows
+    ///   into the parent's tree node, where it waits for the next expansion.
+    ///   So the cost of an expansion or collapse depends on the number of rows
+    ///   shown or hidden only. A collapsed tree costs as much as its top-level rows.
+    ///
+    /// - Sorting orders siblings within their parent.
+    class TreeListBox : public ListBox
+    {
+    protected:
+        /// State of a row, which can have children
+        struct NodeTy {
+            bool bExpanded = false;         ///< children currently shown?
+            bool bFetched = false;          ///< children already requested from the main window?
+            ListRowVecTy hidden;            ///< while collapsed: the descendants, flattened in display order
+        };
+        std::unordered_map<void*,NodeTy> nodes; ///< tree state of all rows, which can have children, by `refCon`
+        
+    public:
+        /// @brief construct a tree list box, for positioning params see struct WidgetAddTy
+        /// @param _caption Label is not actually shown in case of a list box, but might be useful for internal identification
+        /// @param main parent main window
+        TreeListBox (const std::string& _caption,
+                     MainWnd& main,
+                     WidgetPosE lR = POS_ABSOLUTE,        int lO = 0,
+                     WidgetPosE tR = POS_AFTER_PRV,       int tO = 0,
+                     WidgetPosE rR = POS_BOTTOM_RIGHT,    int rO = 0,
+                     WidgetPosE bR = POS_FIXED_LEN,       int bO = 15);
+        
+        /// @brief Define if a row can have children, i.e. can be expanded
+        /// @details Can also be called for rows not yet added,
+        ///          e.g. for children before they are returned from MainWnd::MsgTreeListFetchChildren().
+        ///          Removing the mark from an expanded row collapses it first.
+        virtual void SetHasChildren (void* _refCon, bool _b = true);
+        /// Can the row have children?
+        bool HasChildren (void* _refCon) const { return nodes.count(_refCon) > 0; }
+        /// Is the row expanded, i.e. are its children shown?
+        bool IsExpanded (void* _refCon) const;
+        /// @brief Show a row's children, fetching them first if needed
+        /// @return `false` if the row is not visible, cannot have children, or is already expanded
+        virtual bool Expand (void* _refCon);
+        /// @brief Hide a row's children
+        /// @return `false` if the row is not visible or not expanded
+        virtual bool Collapse (void* _refCon);
+        /// Expand a collapsed row, collapse an expanded one
+        bool ToggleExpand (void* _refCon)
+        { return IsExpanded(_refCon) ? Collapse(_refCon) : Expand(_refCon); }
+        /// @brief Remove a row's children, so they are fetched anew upon next expansion
+        /// @details The row stays expanded if it was, with the new children shown.
+        virtual void Refresh (void* _refCon);
+        
+        /// @brief Add/update a row
+        /// @details A row hidden under a collapsed ancestor is updated in place
+        ///          and stays hidden, other rows are handled by ListBox::AddRow().
+        virtual ListRow& AddRow (ListRow&& row);
+        /// Add/update many rows at once, rows hidden under collapsed ancestors are updated in place
+        virtual void AddRows (ListRowVecTy&& newRows);
+        /// Remove a visible row including all its descendants
+        virtual bool RemoveRow (void* _refCon);
+        /// Remove all selected rows including all their descendants, returns the number of selected rows removed
+        virtual size_t RemoveSelected ();
+        /// Clear a list: Remove all rows
+        virtual void Clear ();
+        
+    protected:
+        /// Indentation by nesting level, plus room for the expansion marker
+        virtual int GetRowIndent (const ListRow& row) const;
+        /// Sort siblings within their parents
+        virtual void DoSortRows ();
+        /// @brief Sort the flattened trees in `_v[_first, _last)` recursively
+        /// @param _v Vector of flattened rows
+        /// @param _first First row of the range, its level is the level of the top-most rows in the range
+        /// @param _last End of the range
+        void DoSortForest (ListRowVecTy& _v, size_t _first, size_t _last);
+        /// @brief Find a row hidden under a collapsed ancestor
+        /// @param _refCon The row's refCon
+        /// @param[out] _pBlock The hidden block holding the row
+        /// @param[out] iter The row's position in `*_pBlock`
+        /// @return Found a hidden row?
+        bool FindHiddenRow (void* _refCon, ListRowVecTy*& _pBlock, ListRowVecTy::iterator& iter);
+        /// Overwrite a hidden row's data with `row`'s, keeping the hidden row's identity
+        void DoUpdateHiddenRow (ListRow& _hidden, ListRow&& row);
+        /// Forget rows: free their slots and drop their tree nodes including hidden descendants
+        void DoDiscardRows (ListRowVecTy::iterator _first, ListRowVecTy::iterator _last);
+        /// Draw the row and its expansion marker
+        virtual void DoDrawRow (const Rect& rowRect, ListRow& row, const float txtColor[4]);
+        /// A click on the expansion marker expands/collapses the row
+        virtual void DoMouseClick (Point p, MouseBtnTy mouseBtn, XPLMMouseStatus inMouse);
+        /// `+` and `-` expand and collapse the current row
+        virtual void DoHandleKey (char inKey, XPLMKeyFlags inFlags, unsigned char inVirtualKey);
+    };
+    
     //
     // MARK: Main Window
     //
@@ -929,6 +1638,32 @@ namespace TFW {
         XPLMWindowPositioningMode beforeVRPosMode = xplm_WindowPositionFree;
         /// Saved mode and position before switching to VR
         Rect beforeVRGeometry;
+        /// Counts of text drawn in the last frame
+        TextStatsTy textStats;
+        /// Values fetched once per drawing frame
+        FrameContext frameCtx;
+        /// Generation of X-Plane's standard colors the window was last drawn with
+        unsigned long xpColorsGenDrawn = 0;
+        /// Shall drawing go through `renderCache`? See SetRenderCache()
+        bool bRenderCache = false;
+        /// Offscreen copy of the window's drawing
+        RenderCacheTy renderCache;
+        /// Areas to be drawn anew, in widget coordinates, disjoint, see AddDamage()
+        std::vector<Rect> damage;
+        /// Counts calls to AddDamage(), which added an area
+        unsigned long damageCnt = 0;
+        /// Max number of times per second the widgets are drawn anew, `0` for every frame, see SetMaxRefreshRate()
+        float maxRefreshRate = 0.0f;
+        /// When the widgets were drawn anew last
+        std::chrono::steady_clock::time_point lastRefresh;
+        /// Draw damaged areas in the next frame, regardless of `maxRefreshRate`? (Set by user input)
+        bool bRefreshNow = false;
+        /// Currently drawing? Then widgets changing while being drawn don't add damage
+        bool bDrawing = false;
+        /// The focus widget when last drawn
+        const Widget* pFocusDrawn = nullptr;
+        /// The focus widget's area when last drawn
+        Rect focusDrawnRect;
     public:
         /// Main window coordinates are global coordinates
         MainWnd (const std::string& _caption,
@@ -963,6 +1698,36 @@ namespace TFW {
         
         /// Set the window title
         virtual void SetCaption (const std::string& _c);
+        /// Set the window title, taking over the string's buffer
+        virtual void SetCaption (std::string&& _c);
+        
+        /// Counts of text drawn in the last frame
+        const TextStatsTy& GetTextStats () const { return textStats; }
+        /// Values of the current drawing frame, to be used by widgets' DoDraw()
+        FrameContext& GetFrameContext () { return frameCtx; }
+        /// Fetch X-Plane's standard colors only every `_nFrames` frames (default: every frame)
+        void SetXPColorsRefresh (unsigned _nFrames) { frameCtx.xpColorsRefresh = _nFrames; }
+        
+        /// @brief Draw widgets into an offscreen texture, and present just that texture as long as no widget is dirty
+        /// @details Falls back to drawing directly if framebuffer objects are not available.
+        ///          Only the areas of dirty widgets are drawn anew into the texture, see AddDamage().
+        virtual void SetRenderCache (bool _bCache = true);
+        /// Does drawing go through the render cache?
+        bool IsRenderCache () const { return bRenderCache; }
+        /// @brief Draw changed widgets at most `_hz` times per second, `0` for every frame
+        /// @details In other frames the render cache is presented as is, so this requires SetRenderCache().
+        ///          User input, like clicks, keys, the blinking caret, or scrolling, is drawn immediately.
+        void SetMaxRefreshRate (float _hz) { maxRefreshRate = std::max(_hz, 0.0f); }
+        /// Max number of times per second the widgets are drawn anew, `0` for every frame
+        float GetMaxRefreshRate () const { return maxRefreshRate; }
+        
+        /// Mark the window dirty, or with `false` clear the dirty state of the window and all its widgets
+        virtual void SetDirty (bool _bDirty = true);
+        /// Is the window or any of its visible widgets dirty?
+        virtual bool IsDirty () const;
+        /// @brief Mark an area, in widget coordinates, to be drawn anew
+        /// @details Overlapping areas are merged. With too many areas all of them become one.
+        void AddDamage (const Rect& _r);
         
         /// Reads the current window's geometry and stores it in the `Rect` members
         virtual void FetchGeometry ()
@@ -1055,6 +1820,13 @@ namespace TFW {
         /// Localize global coordinates to given widget so they become relative to the widget's top left corner
         virtual void LocalizePoint (Point& _p, const WidgetAddTy& _wa);
         
+        /// Add the areas of widgets, which are dirty or lost/gained focus, to `damage`
+        void DoCollectDamage ();
+        /// @brief Draw the background and all widgets
+        /// @param _ofs Offset of widget coordinates to drawing coordinates
+        /// @param _pArea If given, only widgets overlapping this area (in drawing coordinates) are drawn
+        void DoDrawWidgets (const Point& _ofs, const Rect* _pArea = nullptr);
+        
         /// @brief callback for SetTimer()
         /// @see https://developer.x-plane.com/sdk/XPLMProcessing/#XPLMFlightLoop_f
         static float CBTimer (float, float, int, void* _refCon);
@@ -1066,6 +1838,15 @@ namespace TFW {
     public:
         /// The user selected a row in a list box
         virtual void MsgListSelChanged (ListBox&, ListRow&) {}
+        /// @brief The user changed the selection in a multi-selection list box
+        /// @details Sent once per user action, additionally to MsgListSelChanged(),
+        ///          the selection of rows at display positions `_first` to `_last` (inclusive) may have changed.
+        ///          Use ListBox::IsSelected() or ListBox::GetSelectedRefCons() to find out.
+        virtual void MsgListSelRangeChanged (ListBox&, size_t /*_first*/, size_t /*_last*/) {}
+        /// @brief A tree list box needs the children of a row, which is expanded for the first time
+        /// @details Add the children to `_children`, their nesting level is set by the list box.
+        ///          Call TreeListBox::SetHasChildren() for any child, which in turn has children.
+        virtual void MsgTreeListFetchChildren (TreeListBox&, ListRow& /*_parent*/, ListRowVecTy& /*_children*/) {}
         /// The user pressed a button
         virtual void MsgButtonClicked (ButtonPush&) {}
         /// The user pressed a button element in a button array
@@ -1102,6 +1883,30 @@ namespace TFW {
 
     /// Get globally defined color
     const float* GetGlobalColor (ColCodeE _code);
+    
+    /// @brief Computes a collation key for `_s`
+    /// @details Keys of the same collation compare with plain `std::string::operator<`
+    ///          in the order defined by `_coll`.
+    /// @return The key, or a copy of `_s` in case of `COLL_BINARY`
+    std::string MakeCollationKey (const std::string& _s, CollationTy _coll);
+    
+    /// @brief Draw text from a font atlas instead of by one `XPLMDrawString` call per text
+    /// @details With the next window drawing the proportional font is rasterized
+    ///          once into a texture. From then on each window's text is drawn as one
+    ///          batch of textured quads, and text widths are computed from the atlas'
+    ///          glyph metrics. Text with characters beyond printable ASCII is still
+    ///          drawn by `XPLMDrawString`. Off by default.
+    void SetTextAtlas (bool _bEnable);
+    /// Is text drawn from a font atlas?
+    bool IsTextAtlas ();
+    
+    /// @brief Modifier keys currently held down
+    /// @details X-Plane reports modifiers with key presses only, not with mouse clicks.
+    ///          So this queries the platform: `GetKeyState` on Windows,
+    ///          `CGEventSourceFlagsState` on Mac (Command counts as Control),
+    ///          and `XQueryKeymap` on Linux. Returns 0 if the platform can't tell,
+    ///          like on Linux without an X server.
+    XPLMKeyFlags GetModifierKeys ();
 
 } // namespace "TFW"
 
@@ -21,6 +21,9 @@
 
 #include "TFWGraphics.h"
 
+// X-Plane SDK, for drawing and binding textures the way X-Plane keeps track of
+#include "XPLMGraphics.h"
+
 // include platform-specific GL headers
 #if IBM
 #include <windows.h>
@@ -37,6 +40,20 @@
 #include <GL/gl.h>
 #endif
 
+// Resolving GL functions beyond OpenGL 1.1 at runtime
+#if APL
+#include <dlfcn.h>
+#elif LIN
+extern "C" void (*glXGetProcAddressARB(const GLubyte* procName))(void);
+#endif
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
 
 /// Encapsulates all TFW widget definitions
 namespace TFW {
@@ -118,6 +135,676 @@ namespace TFW {
         DrawGL(GL_POLYGON, _pts);
     }
 
+    /// GL state, which clipping and pixel conversion depend on, read once per frame by DrawFrameBegin()
+    static struct FrameGLTy {
+        bool bInFrame = false;              ///< between DrawFrameBegin() and DrawFrameEnd()?
+        GLdouble mv[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};    ///< modelview matrix
+        GLdouble pj[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};    ///< projection matrix
+        std::array<GLint,4> viewport = {0,0,1,1};                   ///< current viewport
+        GLboolean bScissor = GL_FALSE;      ///< scissor test enabled (outside of DrawPushClip())?
+        std::array<GLint,4> scissorBox = {0,0,0,0};                 ///< scissor box (outside of DrawPushClip())
+    } gFrameGL;
+    
+    /// Read the GL state into `gFrameGL`
+    static void ReadFrameGL ()
+    {
+        glGetDoublev(GL_MODELVIEW_MATRIX, gFrameGL.mv);
+        glGetDoublev(GL_PROJECTION_MATRIX, gFrameGL.pj);
+        glGetIntegerv(GL_VIEWPORT, gFrameGL.viewport.data());
+        gFrameGL.bScissor = glIsEnabled(GL_SCISSOR_TEST);
+        if (gFrameGL.bScissor)
+            glGetIntegerv(GL_SCISSOR_BOX, gFrameGL.scissorBox.data());
+    }
+    
+    /// The GL state of the current frame, outside of a frame it is read anew
+    static const FrameGLTy& CurrFrameGL ()
+    {
+        if (!gFrameGL.bInFrame)
+            ReadFrameGL();
+        return gFrameGL;
+    }
+    
+    // Read the GL state needed for drawing once at the beginning of a window's drawing
+    void DrawFrameBegin ()
+    {
+        ReadFrameGL();
+        gFrameGL.bInFrame = true;
+    }
+    
+    // End of a window's drawing
+    void DrawFrameEnd ()
+    {
+        gFrameGL.bInFrame = false;
+    }
+    
+    /// @brief Converts a rectangle in drawing coordinates into window pixels
+    /// @details Drawing coordinates differ from window pixels on scaled UIs,
+    ///          so the corners are converted through the frame's matrices and viewport.
+    /// @return Left, bottom, width, and height in window pixels
+    static std::array<GLint,4> ToWndPixels (const Rect& _r)
+    {
+        const FrameGLTy& gl = CurrFrameGL();
+        const GLdouble* mv = gl.mv;
+        const GLdouble* pj = gl.pj;
+        const GLint* vp = gl.viewport.data();
+        
+        // transform a point into window pixels (column-major matrices)
+        auto toWnd = [&](const Point& p, double& wx, double& wy)
+        {
+            const double e[4] = {
+                mv[0]*p.x() + mv[4]*p.y() + mv[12],
+                mv[1]*p.x() + mv[5]*p.y() + mv[13],
+                mv[2]*p.x() + mv[6]*p.y() + mv[14],
+                mv[3]*p.x() + mv[7]*p.y() + mv[15] };
+            const double cx = pj[0]*e[0] + pj[4]*e[1] + pj[8]*e[2]  + pj[12]*e[3];
+            const double cy = pj[1]*e[0] + pj[5]*e[1] + pj[9]*e[2]  + pj[13]*e[3];
+            double       cw = pj[3]*e[0] + pj[7]*e[1] + pj[11]*e[2] + pj[15]*e[3];
+            if (std::abs(cw) < 1e-12) cw = 1.0;
+            wx = vp[0] + (cx/cw + 1.0) * vp[2] / 2.0;
+            wy = vp[1] + (cy/cw + 1.0) * vp[3] / 2.0;
+            // GL keeps matrices in single precision, don't let rounding errors add a pixel
+            if (std::abs(wx - std::round(wx)) < 0.001) wx = std::round(wx);
+            if (std::abs(wy - std::round(wy)) < 0.001) wy = std::round(wy);
+        };
+        double x1 = 0.0, y1 = 0.0, x2 = 0.0, y2 = 0.0;
+        toWnd(_r.Bl(), x1, y1);
+        toWnd(_r.Tr(), x2, y2);
+        const GLint l = GLint(std::floor(std::min(x1,x2))), b = GLint(std::floor(std::min(y1,y2)));
+        const GLint rt = GLint(std::ceil(std::max(x1,x2))), t = GLint(std::ceil(std::max(y1,y2)));
+        return {l, b, rt-l, t-b};
+    }
+    
+    /// Scissor boxes (x, y, width, height in window pixels) of nested DrawPushClip() calls
+    static std::vector<std::array<GLint,4>> gClipStack;
+    /// Was scissoring already active before our first DrawPushClip()?
+    static GLboolean gClipPrevEnabled = GL_FALSE;
+    /// Scissor box active before our first DrawPushClip()
+    static std::array<GLint,4> gClipPrevBox = {0,0,0,0};
+    
+    // Restricts drawing to a rectangle until DrawPopClip() is called
+    /// glScissor expects window pixels, so the rectangle is converted by ToWndPixels()
+    void DrawPushClip (const Rect& _r)
+    {
+        // queued text is drawn with the clip area it was queued under
+        TextQueueFlush();
+        
+        const std::array<GLint,4> px = ToWndPixels(_r);
+        GLint l = px[0], b = px[1];
+        GLint rt = px[0] + px[2], t = px[1] + px[3];
+        
+        // intersect with the enclosing clip area, which is X-Plane's own if we are the first
+        std::array<GLint,4> outer = {0,0,0,0};
+        bool bOuter = false;
+        if (!gClipStack.empty()) {
+            outer = gClipStack.back();
+            bOuter = true;
+        } else {
+            const FrameGLTy& gl = CurrFrameGL();
+            gClipPrevEnabled = gl.bScissor;
+            if (gClipPrevEnabled) {
+                gClipPrevBox = gl.scissorBox;
+                outer = gClipPrevBox;
+                bOuter = true;
+            }
+        }
+        if (bOuter) {
+            l  = std::max(l, outer[0]);
+            b  = std::max(b, outer[1]);
+            rt = std::min(rt, outer[0] + outer[2]);
+            t  = std::min(t,  outer[1] + outer[3]);
+        }
+        
+        gClipStack.push_back({l, b, std::max(rt-l, 0), std::max(t-b, 0)});
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(gClipStack.back()[0], gClipStack.back()[1],
+                  gClipStack.back()[2], gClipStack.back()[3]);
+    }
+    
+    // Ends the clipping begun by the matching DrawPushClip()
+    void DrawPopClip ()
+    {
+        assert(!gClipStack.empty());
+        TextQueueFlush();
+        gClipStack.pop_back();
+        if (!gClipStack.empty())
+            glScissor(gClipStack.back()[0], gClipStack.back()[1],
+                      gClipStack.back()[2], gClipStack.back()[3]);
+        else if (gClipPrevEnabled)
+            glScissor(gClipPrevBox[0], gClipPrevBox[1], gClipPrevBox[2], gClipPrevBox[3]);
+        else
+            glDisable(GL_SCISSOR_TEST);
+    }
+    
+    // Clear the current clip area to transparent
+    void DrawClearClip ()
+    {
+        assert(!gClipStack.empty());
+        TextQueueFlush();
+        GLfloat clearCol[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearCol);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);       // limited by the scissor box
+        glClearColor(clearCol[0], clearCol[1], clearCol[2], clearCol[3]);
+    }
+    
+    /// Blend function of the current drawing target, changes while drawing into a RenderCacheTy
+    static void DrawStdBlend ();
+    
+    //
+    // MARK: Text Queue
+    //
+    
+    /// A queued text
+    struct TextRunTy {
+        int x, y;                           ///< baseline start
+        float col[4];                       ///< color
+        int fontId;                         ///< XPLMFontID
+        size_t ofs, len;                    ///< text's position in `gTextChars`
+    };
+    
+    static std::vector<TextRunTy> gTextRuns;    ///< queued texts
+    static std::string gTextChars;              ///< characters of all queued texts, each zero-terminated
+    static TextStatsTy gTextStats;              ///< counts of drawn text since TextQueueTakeStats()
+    
+    // Queue a text for drawing by TextQueueFlush()
+    void TextQueueAdd (const float _col[4], int _x, int _y, const std::string& _s, int _fontId)
+    {
+        gTextRuns.push_back({_x, _y, {_col[0], _col[1], _col[2], _col[3]},
+                             _fontId, gTextChars.size(), _s.size()});
+        gTextChars.append(_s.data(), _s.size() + 1);    // including the terminating zero
+    }
+    
+    // Draw all queued text, grouped by font and color
+    void TextQueueFlush ()
+    {
+        if (gTextRuns.empty())
+            return;
+        
+        std::stable_sort(gTextRuns.begin(), gTextRuns.end(),
+                         [](const TextRunTy& a, const TextRunTy& b)
+        {
+            if (a.fontId != b.fontId) return a.fontId < b.fontId;
+            return std::lexicographical_compare(std::begin(a.col), std::end(a.col),
+                                                std::begin(b.col), std::end(b.col));
+        });
+        
+        const TextRunTy* pPrev = nullptr;
+        for (TextRunTy& run: gTextRuns) {
+            if (!pPrev || pPrev->fontId != run.fontId ||
+                std::lexicographical_compare(std::begin(pPrev->col), std::end(pPrev->col),
+                                             std::begin(run.col), std::end(run.col)))
+                gTextStats.numGroups++;
+            pPrev = &run;
+            gTextStats.numRuns++;
+            gTextStats.numChars += run.len;
+            
+            char* s = &gTextChars[run.ofs];
+            if (TextAtlasReady(run.fontId) && TextAtlasCovers(s, run.len))
+                TextAtlasAdd(run.col, run.x, run.y, s, run.len);
+            else {
+                XPLMDrawString(run.col, run.x, run.y, s, nullptr, run.fontId);
+                gTextStats.numDrawStrings++;
+            }
+        }
+        TextAtlasFlush();
+        
+        // keep the capacity for the next frame
+        gTextRuns.clear();
+        gTextChars.clear();
+    }
+    
+    // Return the counts of text drawn since the last call
+    TextStatsTy TextQueueTakeStats ()
+    {
+        const TextStatsTy ret = gTextStats;
+        gTextStats = TextStatsTy();
+        return ret;
+    }
+    
+    //
+    // MARK: Text Atlas
+    //
+    
+    constexpr unsigned char ATLAS_FIRST_CHAR = 32;  ///< first character in the atlas (space)
+    constexpr unsigned char ATLAS_LAST_CHAR = 126;  ///< last character in the atlas (tilde)
+    constexpr int ATLAS_COLS = 16;                  ///< glyph cells per row in the atlas
+    constexpr int ATLAS_NUM_GLYPHS = ATLAS_LAST_CHAR - ATLAS_FIRST_CHAR + 1;
+    
+    /// A glyph's metrics and the texture coordinates of its cell in the atlas
+    struct AtlasGlyphTy {
+        float adv = 0.0f;                   ///< advance width in drawing coordinates
+        float u0 = 0.0f, v0 = 0.0f;         ///< texture coordinates of the cell's bottom-left corner
+        float u1 = 0.0f, v1 = 0.0f;         ///< texture coordinates of the cell's top-right corner
+    };
+    
+    /// Queued glyph quad, corners in drawing coordinates, color premultiplied by alpha
+    struct AtlasQuadTy {
+        float x0, y0, x1, y1;               ///< bottom-left and top-right corner
+        const AtlasGlyphTy* pGlyph;         ///< glyph to draw
+        float col[4];                       ///< premultiplied color
+    };
+    
+    /// The font atlas' state
+    static struct TextAtlasTy {
+        int texId = 0;                      ///< texture id, `0` if not built
+        int fontId = -1;                    ///< font the atlas has been rasterized from
+        int cellW = 0;                      ///< width of a glyph's cell, including 1 unit padding on either side
+        int cellH = 0;                      ///< height of a glyph's cell
+        int baseOfs = 0;                    ///< offset of the baseline from the bottom of a cell
+        Rect failedR;                       ///< scratch area of the last failed build, not tried again
+        int failedFontId = -1;              ///< font of the last failed build
+        std::array<AtlasGlyphTy,ATLAS_NUM_GLYPHS> glyphs;  ///< glyph metrics, indexed by character minus ATLAS_FIRST_CHAR
+        std::vector<AtlasQuadTy> quads;     ///< glyphs queued for drawing
+    } gAtlas;
+    
+    /// Smallest power of two not less than `_n`, as GL 1.1 requires for texture sizes
+    static GLsizei TexSize (GLsizei _n)
+    {
+        GLsizei sz = 1;
+        while (sz < _n)
+            sz *= 2;
+        return sz;
+    }
+    
+    // Rasterizes an X-Plane font once into a texture
+    /// A scratch area found too small is not tried again,
+    /// so a small window doesn't cost the glyph measuring every frame
+    bool TextAtlasBuild (const Rect& _r, int _fontId, int _baseOfs)
+    {
+        if (_fontId == gAtlas.failedFontId && _r == gAtlas.failedR)
+            return false;
+        TextAtlasRelease();
+        gAtlas.failedR = _r;
+        gAtlas.failedFontId = _fontId;
+        
+        // glyph metrics, cells fit the widest glyph
+        int charW = 0, charH = 0;
+        XPLMGetFontDimensions(_fontId, &charW, &charH, nullptr);
+        for (int i = 0; i < ATLAS_NUM_GLYPHS; i++) {
+            const char c = char(ATLAS_FIRST_CHAR + i);
+            gAtlas.glyphs[size_t(i)].adv = XPLMMeasureString(_fontId, &c, 1);
+            charW = std::max(charW, int(std::ceil(gAtlas.glyphs[size_t(i)].adv)));
+        }
+        const int cellW = charW + 2;
+        const int cellH = charH + _baseOfs + 2;
+        const int numRows = (ATLAS_NUM_GLYPHS + ATLAS_COLS - 1) / ATLAS_COLS;
+        
+        // the scratch area must fit, also in terms of window pixels
+        const Rect area (_r.Left(), _r.Top(), _r.Left() + ATLAS_COLS * cellW, _r.Top() - numRows * cellH);
+        if (!_r.Contains(area))
+            return false;
+        const std::array<GLint,4> px = ToWndPixels(area);
+        const GLint* vp = CurrFrameGL().viewport.data();
+        if (px[2] <= 0 || px[3] <= 0 ||
+            px[0] < vp[0] || px[1] < vp[1] ||
+            px[0] + px[2] > vp[0] + vp[2] || px[1] + px[3] > vp[1] + vp[3])
+            return false;
+        
+        int texIds[2] = {0, 0};             // [0] the atlas, [1] saves the scratch area's content
+        XPLMGenerateTextureNumbers(texIds, 2);
+        
+        // the pixels are copied into the bottom-left corner of power-of-two sized textures
+        const GLsizei texW = TexSize(px[2]);
+        const GLsizei texH = TexSize(px[3]);
+        const float uMax = float(px[2]) / float(texW);
+        const float vMax = float(px[3]) / float(texH);
+        
+        // save what is in the scratch area
+        XPLMSetGraphicsState(0, 1, 0, 0, 0, 0, 0);
+        XPLMBindTexture2d(texIds[1], 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texW, texH, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, px[0], px[1], px[2], px[3]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        
+        // draw the glyphs white on black, the brightness becomes the glyph's coverage
+        XPLMSetGraphicsState(0, 0, 0, 0, 0, 0, 0);
+        const float black[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        DrawSetColor(black);
+        DrawRect(area);
+        for (int i = 0; i < ATLAS_NUM_GLYPHS; i++) {
+            const int cellL = area.Left() + (i % ATLAS_COLS) * cellW;
+            const int cellB = area.Top() - (i / ATLAS_COLS + 1) * cellH;
+            char s[2] = { char(ATLAS_FIRST_CHAR + i), 0 };
+            XPLMDrawString(white, cellL + 1, cellB + _baseOfs + 1, s, nullptr, _fontId);
+            
+            AtlasGlyphTy& g = gAtlas.glyphs[size_t(i)];
+            g.u0 = uMax * float(cellL - area.Left()) / float(area.Width());
+            g.u1 = uMax * float(cellL + cellW - area.Left()) / float(area.Width());
+            g.v0 = vMax * float(cellB - area.Bottom()) / float(area.Height());
+            g.v1 = vMax * float(cellB + cellH - area.Bottom()) / float(area.Height());
+        }
+        
+        // copy into the atlas texture, a scaled UI requires filtering,
+        // so the unused part of the texture is cleared to not bleed into the glyphs
+        XPLMSetGraphicsState(0, 1, 0, 0, 0, 0, 0);
+        XPLMBindTexture2d(texIds[0], 0);
+        const std::vector<GLubyte> blank (size_t(texW) * size_t(texH), 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_INTENSITY, texW, texH, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, blank.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, px[0], px[1], px[2], px[3]);
+        const GLint filter = px[2] == area.Width() ? GL_NEAREST : GL_LINEAR;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        
+        // restore the scratch area
+        XPLMBindTexture2d(texIds[1], 0);
+        DrawSetColor(white);
+        glBegin(GL_QUADS);
+        glTexCoord2f(0.0f, 0.0f); glVertex2i(area.Left(),  area.Bottom());
+        glTexCoord2f(uMax, 0.0f); glVertex2i(area.Right(), area.Bottom());
+        glTexCoord2f(uMax, vMax); glVertex2i(area.Right(), area.Top());
+        glTexCoord2f(0.0f, vMax); glVertex2i(area.Left(),  area.Top());
+        glEnd();
+        XPLMBindTexture2d(0, 0);
+        const GLuint saveId = GLuint(texIds[1]);
+        glDeleteTextures(1, &saveId);
+        
+        // back to the standard state for drawing widgets
+        XPLMSetGraphicsState(0, 0, 0, 0, 1, 0, 0);
+        
+        gAtlas.texId = texIds[0];
+        gAtlas.fontId = _fontId;
+        gAtlas.failedFontId = -1;
+        gAtlas.cellW = cellW;
+        gAtlas.cellH = cellH;
+        gAtlas.baseOfs = _baseOfs;
+        return true;
+    }
+    
+    // Is the atlas ready to draw and measure text in the given font?
+    bool TextAtlasReady (int _fontId)
+    {
+        return gAtlas.texId && gAtlas.fontId == _fontId;
+    }
+    
+    // Are all characters of the text available in the atlas?
+    bool TextAtlasCovers (const char* _s, size_t _len)
+    {
+        for (size_t i = 0; i < _len; i++)
+            if ((unsigned char)_s[i] < ATLAS_FIRST_CHAR || (unsigned char)_s[i] > ATLAS_LAST_CHAR)
+                return false;
+        return true;
+    }
+    
+    // Width of a text as per the atlas' glyph metrics
+    /// X-Plane's fonts don't kern, so a text's width is the sum of its glyphs' advances
+    float TextAtlasMeasure (const char* _s, size_t _len)
+    {
+        float w = 0.0f;
+        for (size_t i = 0; i < _len; i++)
+            w += gAtlas.glyphs[size_t((unsigned char)_s[i] - ATLAS_FIRST_CHAR)].adv;
+        return w;
+    }
+    
+    // Queue a text for drawing by TextAtlasFlush()
+    void TextAtlasAdd (const float _col[4], int _x, int _y, const char* _s, size_t _len)
+    {
+        const float y0 = float(_y - gAtlas.baseOfs - 1);
+        const float y1 = y0 + float(gAtlas.cellH);
+        float x = float(_x - 1);            // glyph cells have 1 unit padding
+        for (size_t i = 0; i < _len; i++) {
+            const AtlasGlyphTy& g = gAtlas.glyphs[size_t((unsigned char)_s[i] - ATLAS_FIRST_CHAR)];
+            const float x0 = std::round(x);
+            gAtlas.quads.push_back({x0, y0, x0 + float(gAtlas.cellW), y1, &g,
+                                    {_col[0]*_col[3], _col[1]*_col[3], _col[2]*_col[3], _col[3]}});
+            x += g.adv;
+        }
+    }
+    
+    // Draw all queued text in one batch
+    void TextAtlasFlush ()
+    {
+        if (gAtlas.quads.empty())
+            return;
+        if (gAtlas.texId) {
+            XPLMSetGraphicsState(0, 1, 0, 0, 1, 0, 0);
+            XPLMBindTexture2d(gAtlas.texId, 0);
+            // the texture's intensity modulates color and alpha,
+            // so colors are premultiplied and blending must not multiply by alpha again
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+            glBegin(GL_QUADS);
+            for (const AtlasQuadTy& q: gAtlas.quads) {
+                glColor4fv(q.col);
+                glTexCoord2f(q.pGlyph->u0, q.pGlyph->v0); glVertex2f(q.x0, q.y0);
+                glTexCoord2f(q.pGlyph->u1, q.pGlyph->v0); glVertex2f(q.x1, q.y0);
+                glTexCoord2f(q.pGlyph->u1, q.pGlyph->v1); glVertex2f(q.x1, q.y1);
+                glTexCoord2f(q.pGlyph->u0, q.pGlyph->v1); glVertex2f(q.x0, q.y1);
+            }
+            glEnd();
+            DrawStdBlend();
+            XPLMSetGraphicsState(0, 0, 0, 0, 1, 0, 0);
+        }
+        gAtlas.quads.clear();
+    }
+    
+    // Free the atlas' texture
+    void TextAtlasRelease ()
+    {
+        gAtlas.quads.clear();
+        if (gAtlas.texId) {
+            XPLMBindTexture2d(0, 0);
+            const GLuint id = GLuint(gAtlas.texId);
+            glDeleteTextures(1, &id);
+            gAtlas.texId = 0;
+        }
+        gAtlas.fontId = -1;
+    }
+    
+    //
+    // MARK: Render Cache
+    //
+    
+    // GL constants of framebuffer objects (OpenGL 3.0 / ARB_framebuffer_object), not in OpenGL 1.1 headers
+    constexpr GLenum TFW_GL_FRAMEBUFFER                 = 0x8D40;
+    constexpr GLenum TFW_GL_READ_FRAMEBUFFER            = 0x8CA8;
+    constexpr GLenum TFW_GL_DRAW_FRAMEBUFFER            = 0x8CA9;
+    constexpr GLenum TFW_GL_DRAW_FRAMEBUFFER_BINDING    = 0x8CA6;
+    constexpr GLenum TFW_GL_READ_FRAMEBUFFER_BINDING    = 0x8CAA;
+    constexpr GLenum TFW_GL_COLOR_ATTACHMENT0           = 0x8CE0;
+    constexpr GLenum TFW_GL_FRAMEBUFFER_COMPLETE        = 0x8CD5;
+    
+    /// GL functions needed for the render cache, resolved at runtime
+    static struct FBOFuncsTy {
+        bool bResolved = false;             ///< tried resolving the functions already?
+        bool bAvail = false;                ///< all framebuffer functions available?
+        void (APIENTRY *genFramebuffers)(GLsizei, GLuint*) = nullptr;
+        void (APIENTRY *deleteFramebuffers)(GLsizei, const GLuint*) = nullptr;
+        void (APIENTRY *bindFramebuffer)(GLenum, GLuint) = nullptr;
+        void (APIENTRY *framebufferTexture2D)(GLenum, GLenum, GLenum, GLuint, GLint) = nullptr;
+        GLenum (APIENTRY *checkFramebufferStatus)(GLenum) = nullptr;
+        void (APIENTRY *blendFuncSeparate)(GLenum, GLenum, GLenum, GLenum) = nullptr;
+    } gFBO;
+    
+    /// State saved by RenderCacheBegin() to be restored by RenderCacheEnd()
+    static struct RenderCacheStateTy {
+        bool bActive = false;               ///< currently drawing into a cache?
+        GLint drawFBO = 0;                  ///< framebuffer object drawn into before
+        GLint readFBO = 0;                  ///< framebuffer object read from before
+        std::array<GLint,4> viewport = {0,0,0,0};   ///< viewport before
+        GLboolean bScissor = GL_FALSE;      ///< scissor test enabled before?
+    } gCacheState;
+    
+    /// Resolve a GL function by name, `nullptr` if not available
+    template <class FuncT>
+    static void GLResolve (FuncT& _f, const char* _name)
+    {
+#if IBM
+        _f = reinterpret_cast<FuncT>(wglGetProcAddress(_name));
+#elif APL
+        _f = reinterpret_cast<FuncT>(dlsym(RTLD_DEFAULT, _name));
+#else
+        _f = reinterpret_cast<FuncT>(glXGetProcAddressARB(reinterpret_cast<const GLubyte*>(_name)));
+#endif
+    }
+    
+    // Are framebuffer objects available?
+    bool RenderCacheAvail ()
+    {
+        if (!gFBO.bResolved) {
+            gFBO.bResolved = true;
+            GLResolve(gFBO.genFramebuffers,         "glGenFramebuffers");
+            GLResolve(gFBO.deleteFramebuffers,      "glDeleteFramebuffers");
+            GLResolve(gFBO.bindFramebuffer,         "glBindFramebuffer");
+            GLResolve(gFBO.framebufferTexture2D,    "glFramebufferTexture2D");
+            GLResolve(gFBO.checkFramebufferStatus,  "glCheckFramebufferStatus");
+            GLResolve(gFBO.blendFuncSeparate,       "glBlendFuncSeparate");
+            gFBO.bAvail = gFBO.genFramebuffers && gFBO.deleteFramebuffers &&
+                          gFBO.bindFramebuffer && gFBO.framebufferTexture2D &&
+                          gFBO.checkFramebufferStatus;
+        }
+        return gFBO.bAvail;
+    }
+    
+    // Blend function of the current drawing target
+    /// The cache's texture is later drawn with premultiplied alpha,
+    /// so while drawing into it the alpha channel must accumulate coverage, not be multiplied by alpha again
+    static void DrawStdBlend ()
+    {
+        if (gCacheState.bActive && gFBO.blendFuncSeparate)
+            gFBO.blendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        else
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    
+    // Redirect drawing into the cache's texture
+    bool RenderCacheBegin (RenderCacheTy& _c, const Rect& _r, bool _bKeep)
+    {
+        assert(!gCacheState.bActive);
+        if (!RenderCacheAvail())
+            return false;
+        const std::array<GLint,4> px = ToWndPixels(_r);
+        if (px[2] <= 0 || px[3] <= 0)
+            return false;
+        
+        // queued text still goes where drawing went so far
+        TextQueueFlush();
+        _bKeep = _bKeep && _c.bValid && _c.pxWidth == px[2] && _c.pxHeight == px[3];
+        _c.bValid = false;
+        
+        // (re)allocate texture and framebuffer object if the size changed
+        if (!_c.fbo || _c.pxWidth != px[2] || _c.pxHeight != px[3]) {
+            RenderCacheRelease(_c);
+            XPLMGenerateTextureNumbers(&_c.texId, 1);
+            XPLMBindTexture2d(_c.texId, 0);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, px[2], px[3], 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            XPLMBindTexture2d(0, 0);
+            _c.pxWidth = px[2];
+            _c.pxHeight = px[3];
+            gFBO.genFramebuffers(1, &_c.fbo);
+        }
+        
+        // save where drawing went so far
+        glGetIntegerv(TFW_GL_DRAW_FRAMEBUFFER_BINDING, &gCacheState.drawFBO);
+        glGetIntegerv(TFW_GL_READ_FRAMEBUFFER_BINDING, &gCacheState.readFBO);
+        gCacheState.viewport = CurrFrameGL().viewport;
+        gCacheState.bScissor = gFrameGL.bScissor;
+        
+        // draw into the texture
+        gFBO.bindFramebuffer(TFW_GL_FRAMEBUFFER, _c.fbo);
+        gFBO.framebufferTexture2D(TFW_GL_FRAMEBUFFER, TFW_GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, GLuint(_c.texId), 0);
+        if (gFBO.checkFramebufferStatus(TFW_GL_FRAMEBUFFER) != TFW_GL_FRAMEBUFFER_COMPLETE) {
+            // this driver can't render into our texture, don't try again
+            gFBO.bindFramebuffer(TFW_GL_DRAW_FRAMEBUFFER, GLuint(gCacheState.drawFBO));
+            gFBO.bindFramebuffer(TFW_GL_READ_FRAMEBUFFER, GLuint(gCacheState.readFBO));
+            RenderCacheRelease(_c);
+            gFBO.bAvail = false;
+            return false;
+        }
+        gCacheState.bActive = true;
+        
+        // shift the viewport, so that `_r` ends up in the texture's origin with unchanged matrices
+        glViewport(gCacheState.viewport[0] - px[0], gCacheState.viewport[1] - px[1],
+                   gCacheState.viewport[2], gCacheState.viewport[3]);
+        glDisable(GL_SCISSOR_TEST);
+        gFrameGL.viewport = {gCacheState.viewport[0] - px[0], gCacheState.viewport[1] - px[1],
+                             gCacheState.viewport[2], gCacheState.viewport[3]};
+        gFrameGL.bScissor = GL_FALSE;
+        
+        // start off transparent
+        if (!_bKeep) {
+            GLfloat clearCol[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            glGetFloatv(GL_COLOR_CLEAR_VALUE, clearCol);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glClearColor(clearCol[0], clearCol[1], clearCol[2], clearCol[3]);
+        }
+        
+        DrawStdBlend();
+        return true;
+    }
+    
+    // Ends drawing into the cache
+    void RenderCacheEnd (RenderCacheTy& _c)
+    {
+        assert(gCacheState.bActive);
+        TextQueueFlush();
+        
+        gFBO.bindFramebuffer(TFW_GL_DRAW_FRAMEBUFFER, GLuint(gCacheState.drawFBO));
+        gFBO.bindFramebuffer(TFW_GL_READ_FRAMEBUFFER, GLuint(gCacheState.readFBO));
+        glViewport(gCacheState.viewport[0], gCacheState.viewport[1],
+                   gCacheState.viewport[2], gCacheState.viewport[3]);
+        if (gCacheState.bScissor)
+            glEnable(GL_SCISSOR_TEST);
+        gFrameGL.viewport = gCacheState.viewport;
+        gFrameGL.bScissor = gCacheState.bScissor;
+        gCacheState.bActive = false;
+        DrawStdBlend();
+        
+        _c.bValid = true;
+    }
+    
+    // Does the cache hold a drawing of `_r`'s size in pixels?
+    bool RenderCacheFits (const RenderCacheTy& _c, const Rect& _r)
+    {
+        if (!_c.bValid)
+            return false;
+        const std::array<GLint,4> px = ToWndPixels(_r);
+        return px[2] == _c.pxWidth && px[3] == _c.pxHeight;
+    }
+    
+    // Draw the cache's texture
+    bool RenderCacheDraw (const RenderCacheTy& _c, const Rect& _r)
+    {
+        if (gCacheState.bActive || !RenderCacheFits(_c, _r))
+            return false;
+        
+        XPLMSetGraphicsState(0, 1, 0, 0, 1, 0, 0);
+        XPLMBindTexture2d(_c.texId, 0);
+        // colors in the texture are premultiplied by alpha already
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+        glBegin(GL_QUADS);
+        glTexCoord2f(0.0f, 0.0f); glVertex2i(_r.Left(),  _r.Bottom());
+        glTexCoord2f(1.0f, 0.0f); glVertex2i(_r.Right(), _r.Bottom());
+        glTexCoord2f(1.0f, 1.0f); glVertex2i(_r.Right(), _r.Top());
+        glTexCoord2f(0.0f, 1.0f); glVertex2i(_r.Left(),  _r.Top());
+        glEnd();
+        DrawStdBlend();
+        XPLMSetGraphicsState(0, 0, 0, 0, 1, 0, 0);
+        return true;
+    }
+    
+    // Free the cache's framebuffer object and texture
+    void RenderCacheRelease (RenderCacheTy& _c)
+    {
+        if (_c.fbo && gFBO.deleteFramebuffers)
+            gFBO.deleteFramebuffers(1, &_c.fbo);
+        _c.fbo = 0;
+        if (_c.texId) {
+            XPLMBindTexture2d(0, 0);
+            const GLuint id = GLuint(_c.texId);
+            glDeleteTextures(1, &id);
+            _c.texId = 0;
+        }
+        _c.pxWidth = _c.pxHeight = 0;
+        _c.bValid = false;
+    }
+    
     // Draws a single check box
     void DrawCheckBox (const Rect& _r, bool _bSel, bool _bThick)
     {
@@ -165,6 +852,20 @@ namespace TFW {
             });
     }
 
+    // Draw a horizontal resize cursor
+    void DrawResizeCursor (const Point& _c, int _size)
+    {
+        const int h = _size/2;                      // size of the arrow heads
+        // vertical bar and horizontal line
+        DrawLine({
+            _c + Point(0, h),       _c + Point(0, -h),
+            _c + Point(-_size, 0),  _c + Point(_size, 0)
+        });
+        // arrow heads
+        DrawPolygon({ _c + Point(-_size, 0), _c + Point(-_size+h, h), _c + Point(-_size+h, -h) });
+        DrawPolygon({ _c + Point( _size, 0), _c + Point( _size-h, -h), _c + Point( _size-h, h) });
+    }
+
     // Draw an approximation of a circle
     /// @see https://community.khronos.org/t/how-to-draw-circle/59661/6
     void DrawCircle (const Point& _c, int _r, bool _bFilled, int _coarseness)
@@ -25,6 +25,7 @@
 #include <cassert>
 #include <valarray>
 #include <cmath>
+#include <string>
 
 /// Encapsulates all TFW widget definitions
 namespace TFW {
@@ -200,6 +201,23 @@ namespace TFW {
     /// @param _pts list of points defining the polygon
     void DrawPolygon (std::initializer_list<Point> _pts);
 
+    /// @brief Read the GL state needed for drawing once at the beginning of a window's drawing
+    /// @details Matrices, viewport, and scissor state are kept until DrawFrameEnd(),
+    ///          so that DrawPushClip() and the pixel conversions don't query GL each time.
+    ///          In between, the viewport and scissor test are to be changed
+    ///          only by the Draw... and RenderCache... functions.
+    void DrawFrameBegin ();
+    /// End of a window's drawing, outside of a frame the GL state is queried when needed
+    void DrawFrameEnd ();
+
+    /// @brief Restricts drawing to a rectangle until DrawPopClip() is called
+    /// @details Clip rectangles nest, the effective area is the intersection with the enclosing clip rectangle
+    void DrawPushClip (const Rect& _r);
+    /// Ends the clipping begun by the matching DrawPushClip()
+    void DrawPopClip ();
+    /// Clear the current clip area to transparent, e.g. before drawing parts of a RenderCacheTy anew
+    void DrawClearClip ();
+
     /// @brief Draw a checkbox
     /// @param _r Outer drawing rectangle, size of the check box
     /// @param _bSel Selected? `true` for drawing an inside X
@@ -211,12 +229,99 @@ namespace TFW {
     /// @param _bThick Draw a thick frame around the radio button instead of a thin?
     void DrawRadioButton (const Rect& _r, bool _bSel, bool _bThick);
 
+    /// @brief Draw a horizontal resize cursor, a vertical bar with arrows to the left and right
+    /// @param _c Center point of the cursor
+    /// @param _size Distance from center to the arrow tips
+    void DrawResizeCursor (const Point& _c, int _size = 8);
+
     /// @brief Draw  an approximation of a circle
     /// @param _c Center point of circle
     /// @param _r radius
     /// @param _bFilled Filled circle (as opposed to circumfence ony)?
     /// @param _coarseness Max length of a segment, less = finer, but more expensive
     void DrawCircle (const Point& _c, int _r, bool _bFilled = false, int _coarseness = 5);
+    
+    //
+    // MARK: Text Queue
+    //
+    
+    /// Counts of text drawn by TextQueueFlush(), see TextQueueTakeStats()
+    struct TextStatsTy {
+        size_t numRuns = 0;                 ///< number of texts drawn
+        size_t numChars = 0;                ///< number of characters drawn
+        size_t numGroups = 0;               ///< number of font/color groups drawn
+        size_t numDrawStrings = 0;          ///< number of texts drawn by `XPLMDrawString`, the others came from the font atlas
+    };
+    
+    /// @brief Queue a text with its baseline starting at `_x`/`_y` for drawing by TextQueueFlush()
+    /// @details The text is copied, so it may change or go away before the flush.
+    void TextQueueAdd (const float _col[4], int _x, int _y, const std::string& _s, int _fontId);
+    /// @brief Draw all queued text, grouped by font and color
+    /// @details Called at the end of a window's drawing, and before the clip area changes.
+    ///          Call it also before drawing anything that needs to cover queued text, like a caret.
+    ///          Text goes to the font atlas if it is ready, otherwise to `XPLMDrawString`.
+    void TextQueueFlush ();
+    /// Return the counts of text drawn since the last call
+    TextStatsTy TextQueueTakeStats ();
+    
+    //
+    // MARK: Text Atlas
+    //
+    
+    /// @brief Rasterizes an X-Plane font once into a texture, so that text can be drawn as batched textured quads
+    /// @details Needs to be called from within a drawing callback. The printable ASCII
+    ///          glyphs are drawn by `XPLMDrawString` into the top-left corner of `_r`
+    ///          and copied into a texture, then the previous content of that area is restored.
+    /// @param _r Scratch area in current drawing coordinates, needs to fit 16 x 6 glyphs
+    /// @param _fontId The `XPLMFontID` to rasterize
+    /// @param _baseOfs Offset of the text's baseline from the bottom of a glyph's cell
+    /// @return Is the atlas ready? `false` if `_r` is too small,
+    ///         then calls with the same `_r` and `_fontId` return `false` right away
+    bool TextAtlasBuild (const Rect& _r, int _fontId, int _baseOfs);
+    /// Is the atlas ready to draw and measure text in the given font?
+    bool TextAtlasReady (int _fontId);
+    /// Are all characters of the text available in the atlas?
+    bool TextAtlasCovers (const char* _s, size_t _len);
+    /// Width of a text as per the atlas' glyph metrics
+    float TextAtlasMeasure (const char* _s, size_t _len);
+    /// Queue a text with its baseline starting at `_x`/`_y` for drawing by TextAtlasFlush()
+    void TextAtlasAdd (const float _col[4], int _x, int _y, const char* _s, size_t _len);
+    /// Draw all text queued for the atlas in one batch, called by TextQueueFlush()
+    void TextAtlasFlush ();
+    /// Free the atlas' texture
+    void TextAtlasRelease ();
+    
+    //
+    // MARK: Render Cache
+    //
+    
+    /// @brief Offscreen texture holding a window's drawing, so that it can be presented again without drawing anew
+    /// @see RenderCacheBegin()
+    struct RenderCacheTy {
+        unsigned fbo = 0;                   ///< framebuffer object drawing goes into
+        int texId = 0;                      ///< texture attached to the framebuffer object
+        int pxWidth = 0;                    ///< texture width in pixels
+        int pxHeight = 0;                   ///< texture height in pixels
+        bool bValid = false;                ///< does the texture hold a complete drawing?
+    };
+    
+    /// Are framebuffer objects available, so that RenderCacheBegin() can succeed?
+    bool RenderCacheAvail ();
+    /// @brief Redirect drawing into the cache's texture, which covers `_r`
+    /// @details Drawing coordinates stay the same. The texture is (re)allocated
+    ///          to the size of `_r` in pixels and cleared to transparent.
+    /// @param _bKeep Keep the previous drawing, so that only parts of it are drawn anew, requires RenderCacheFits()
+    /// @return `false` if framebuffer objects are not available, then drawing needs to go to the screen directly
+    bool RenderCacheBegin (RenderCacheTy& _c, const Rect& _r, bool _bKeep = false);
+    /// Ends drawing into the cache, drawing goes again where it went before RenderCacheBegin()
+    void RenderCacheEnd (RenderCacheTy& _c);
+    /// Does the cache hold a drawing of `_r`'s size in pixels?
+    bool RenderCacheFits (const RenderCacheTy& _c, const Rect& _r);
+    /// @brief Draw the cache's texture to `_r`
+    /// @return `false` if the cache holds no drawing of `_r`'s size in pixels, then nothing was drawn
+    bool RenderCacheDraw (const RenderCacheTy& _c, const Rect& _r);
+    /// Free the cache's framebuffer object and texture
+    void RenderCacheRelease (RenderCacheTy& _c);
 
 } // namespace "TFW"
 
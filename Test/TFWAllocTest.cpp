@@ -0,0 +1,174 @@
+//
+//  TFWidgets Tests: Strings are moved, not copied, on their way into a list
+//
+
+/*
+ * Copyright (c) 2019, Birger Hoppe
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// include TFW header
+#include "TFW.h"
+
+// include other C++ headers
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace TFW;
+
+//
+// MARK: Allocation counting
+//
+
+static long gAllocCnt = 0;              ///< number of allocations counted so far
+static bool gbCountAllocs = false;      ///< count allocations right now?
+
+void* operator new (size_t n)
+{
+    if (gbCountAllocs)
+        gAllocCnt++;
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete (void* p) noexcept { std::free(p); }
+void operator delete (void* p, size_t) noexcept { std::free(p); }
+
+/// Start counting allocations
+static void CountStart () { gAllocCnt = 0; gbCountAllocs = true; }
+/// Stop counting and return the number of allocations since CountStart()
+static long CountStop () { gbCountAllocs = false; return gAllocCnt; }
+
+//
+// MARK: Test helpers
+//
+
+static int gFailures = 0;               ///< number of failed checks
+
+/// Report a failed check
+#define CHECK(cond) \
+    if (!(cond)) { gFailures++; std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); }
+
+/// A string too long for the small-string buffer, so that it lives on the heap
+static std::string LongString (int _i)
+{
+    return "a fairly long string value, number " + std::to_string(_i);
+}
+
+/// Main window holding the list box under test
+class TestWnd : public MainWnd
+{
+public:
+    ListBox lb;
+public:
+    TestWnd () : MainWnd("Test", 0, 600, 800, 0), lb("lb", *this)
+    {
+        lb.AddCol(0, {"Name", 200});
+        lb.AddCol(1, {"Value", 200});
+        lb.SetSorting(0, SORT_ASCENDING);
+    }
+};
+
+//
+// MARK: Tests
+//
+
+/// Moving a string into a ListItem, or setting it, takes over the buffer
+static void TestListItem ()
+{
+    std::string s = LongString(1);
+    const char* pBuf = s.data();
+    CountStart();
+    ListItem li(std::move(s));
+    CHECK(CountStop() == 0);
+    CHECK(li.GetS().data() == pBuf);
+
+    s = LongString(2);
+    pBuf = s.data();
+    CountStart();
+    li.Set(std::move(s));
+    CHECK(CountStop() == 0);
+    CHECK(li.GetS().data() == pBuf);
+}
+
+/// Adding a row of moved strings does not copy the strings
+static void TestAddRow (ListBox& lb)
+{
+    // Warm up the list's bookkeeping, so that it has capacity for the rows below
+    for (int i = 0; i < 8; i++)
+        lb.AddRow(ListRow((void*)(intptr_t)(100+i), {LongString(i), LongString(i)}));
+    for (int i = 0; i < 8; i++)
+        lb.RemoveRow((void*)(intptr_t)(100+i));
+
+    for (int i = 1; i <= 4; i++) {
+        std::string a = LongString(i), b = LongString(-i);
+        const char* pA = a.data();
+        const char* pB = b.data();
+        std::vector<ListItem> v;
+        v.reserve(2);
+
+        CountStart();
+        v.emplace_back(std::move(a));
+        v.emplace_back(std::move(b));
+        CHECK(CountStop() == 0);
+
+        CountStart();
+        ListRow& row = lb.AddRow(ListRow((void*)(intptr_t)i, std::move(v)));
+        CHECK(CountStop() == 0);
+        CHECK(row[0].GetS().data() == pA);
+        CHECK(row[1].GetS().data() == pB);
+
+        // Replace a value in place
+        std::string c = LongString(10*i);
+        const char* pC = c.data();
+        CountStart();
+        row.Set(1, std::move(c));
+        CHECK(CountStop() == 0);
+        CHECK(row[1].GetS().data() == pC);
+    }
+}
+
+/// Setting a caption from a moved string takes over the buffer
+static void TestSetCaption (Widget& w)
+{
+    std::string s = LongString(3);
+    const char* pBuf = s.data();
+    CountStart();
+    w.SetCaption(std::move(s));
+    CHECK(CountStop() == 0);
+    CHECK(w.GetCaption().data() == pBuf);
+}
+
+int main ()
+{
+    TestWnd wnd;
+    TestListItem();
+    TestAddRow(wnd.lb);
+    TestSetCaption(wnd.lb);
+    TestSetCaption(wnd);
+
+    if (gFailures)
+        std::fprintf(stderr, "%d check(s) failed\n", gFailures);
+    else
+        std::printf("All checks passed\n");
+    return gFailures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
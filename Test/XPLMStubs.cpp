@@ -0,0 +1,78 @@
+//
+//  TFWidgets Tests: Minimal X-Plane SDK stand-ins
+//
+
+/*
+ * Copyright (c) 2019, Birger Hoppe
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+// The tests run outside of X-Plane, so the XPLM functions TFWidgets
+// calls are replaced by these stand-ins: a fixed 800x600 window,
+// an 8x10 boxel font, and no actual drawing.
+
+#include "XPLMDisplay.h"
+#include "XPLMGraphics.h"
+#include "XPLMDataAccess.h"
+#include "XPLMProcessing.h"
+#include "XPLMUtilities.h"
+
+extern "C" {
+
+// Windows
+XPLMWindowID XPLMCreateWindowEx (XPLMCreateWindow_t*) { return (XPLMWindowID)1; }
+void XPLMDestroyWindow (XPLMWindowID) {}
+void XPLMGetWindowGeometry (XPLMWindowID, int* l, int* t, int* r, int* b)
+{ if (l) *l = 0; if (t) *t = 600; if (r) *r = 800; if (b) *b = 0; }
+void XPLMGetWindowGeometryOS (XPLMWindowID, int*, int*, int*, int*) {}
+void XPLMGetWindowGeometryVR (XPLMWindowID, int*, int*) {}
+void XPLMSetWindowGeometry (XPLMWindowID, int, int, int, int) {}
+void XPLMSetWindowGeometryOS (XPLMWindowID, int, int, int, int) {}
+void XPLMSetWindowGeometryVR (XPLMWindowID, int, int) {}
+void XPLMSetWindowTitle (XPLMWindowID, const char*) {}
+int  XPLMWindowIsInVR (XPLMWindowID) { return 0; }
+int  XPLMWindowIsPoppedOut (XPLMWindowID) { return 0; }
+int  XPLMGetWindowIsVisible (XPLMWindowID) { return 1; }
+void XPLMSetWindowIsVisible (XPLMWindowID, int) {}
+void XPLMTakeKeyboardFocus (XPLMWindowID) {}
+int  XPLMHasKeyboardFocus (XPLMWindowID) { return 1; }
+void XPLMSetWindowPositioningMode (XPLMWindowID, XPLMWindowPositioningMode, int) {}
+
+// Fonts and graphics
+void XPLMDrawString (float*, int, int, char*, int*, XPLMFontID) {}
+void XPLMGetFontDimensions (XPLMFontID, int* w, int* h, int* d)
+{ if (w) *w = 8; if (h) *h = 10; if (d) *d = 0; }
+float XPLMMeasureString (XPLMFontID, const char*, int n) { return 8.0f * n; }
+void XPLMSetGraphicsState (int, int, int, int, int, int, int) {}
+void XPLMGenerateTextureNumbers (int* ids, int n) { for (int i = 0; i < n; i++) ids[i] = i+1; }
+void XPLMBindTexture2d (int, int) {}
+
+// Datarefs
+XPLMDataRef XPLMFindDataRef (const char*) { return (XPLMDataRef)1; }
+int XPLMGetDatavf (XPLMDataRef, float* v, int, int n) { for (int i = 0; i < n; i++) v[i] = 0.5f; return n; }
+
+// Processing
+void XPLMRegisterFlightLoopCallback (XPLMFlightLoop_f, float, void*) {}
+void XPLMSetFlightLoopCallbackInterval (XPLMFlightLoop_f, float, int, void*) {}
+void XPLMUnregisterFlightLoopCallback (XPLMFlightLoop_f, void*) {}
+float XPLMGetElapsedTime () { static float t = 0.0f; return t += 0.016f; }
+int XPLMGetCycleNumber () { static int c = 0; return ++c; }
+
+}